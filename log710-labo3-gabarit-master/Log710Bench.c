@@ -0,0 +1,759 @@
+#include <inttypes.h>
+#include <malloc.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "libmem.h"
+
+#define DEFAULT_SIZE (64 * 1024 * 1024)
+#define DEFAULT_THREADS 4
+#define DEFAULT_OPS 20000
+#define DEFAULT_SEED 710
+
+#define SLOTS 1024
+#define LIFO_DEPTH 256
+#define RING_SIZE 1024
+#define LARSON_ROUND 1000
+#define LATENCY_SAMPLE_MASK 7
+#define FOOTPRINT_SAMPLE_MASK 1023
+#define SMALL_FREE_BLOCK_SIZE 16
+
+#define WARN(fmt, ...)                                                                 \
+    do {                                                                               \
+        (void)fprintf(stderr, "[%s:%u] " fmt "\n", __FILE__, __LINE__, ##__VA_ARGS__); \
+    } while (false)
+
+#define ERROR(fmt, ...)           \
+    do {                          \
+        WARN(fmt, ##__VA_ARGS__); \
+        exit(EXIT_FAILURE);       \
+    } while (false)
+
+typedef struct allocator {
+    const char* name;
+    bool libmem;
+    mem_strategy_t strategy;
+} allocator_t;
+
+static const allocator_t allocators[] = {
+    { "first-fit", true, MEM_FIRST_FIT },
+    { "best-fit", true, MEM_BEST_FIT },
+    { "worst-fit", true, MEM_WORST_FIT },
+    { "next-fit", true, MEM_NEXT_FIT },
+    { "adaptive", true, MEM_ADAPTIVE },
+    { "malloc", false, 0 },
+    { NULL, false, 0 },
+};
+
+struct bench;
+
+typedef struct bench_thread {
+    struct bench* bench;
+    size_t index;
+    unsigned int seed;
+    void** slots;
+    size_t slot_count;
+    uint64_t* latencies;
+    size_t latency_count;
+    size_t latency_capacity;
+    size_t ops;
+    size_t failed;
+    uint64_t start;
+    uint64_t end;
+} bench_thread_t;
+
+typedef void(workload_t)(bench_thread_t* thread);
+
+typedef struct bench {
+    const allocator_t* allocator;
+    workload_t* workload;
+    size_t threads;
+    size_t ops;
+    pthread_barrier_t start;
+    pthread_barrier_t round;
+    atomic_size_t peak;
+    void** shared_slots;
+    void* _Atomic* rings;
+    atomic_size_t* ring_heads;
+    atomic_size_t* ring_tails;
+    atomic_bool stop;
+} bench_t;
+
+struct {
+    size_t size;
+    size_t threads;
+    size_t ops;
+    unsigned int seed;
+    const char* workload;
+    const char* allocator;
+    size_t monitor;
+    mem_options_t heap;
+} options = {
+    .size = DEFAULT_SIZE,
+    .threads = DEFAULT_THREADS,
+    .ops = DEFAULT_OPS,
+    .seed = DEFAULT_SEED,
+    .workload = NULL,
+    .allocator = NULL,
+    .monitor = 0,
+    .heap = { .min_split = 1, .rounding = MEM_ROUND_NONE },
+};
+
+static void parse_options(int argc, char** argv);
+
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static size_t footprint(const allocator_t* allocator)
+{
+    if (allocator->libmem) {
+        // NOTE: Les grosses allocations vivent hors du tas, dans leurs propres
+        // projections.
+        mem_stats_t stats;
+        mem_get_stats(&stats);
+        return options.size - stats.free_bytes + stats.large_bytes;
+    }
+
+    return mallinfo2().uordblks;
+}
+
+static void sample(bench_thread_t* thread, uint64_t start)
+{
+    if (start != 0 && thread->latency_count < thread->latency_capacity) {
+        thread->latencies[thread->latency_count++] = now_ns() - start;
+    }
+
+    if ((thread->ops & FOOTPRINT_SAMPLE_MASK) == 0) {
+        size_t current = footprint(thread->bench->allocator);
+        size_t peak = atomic_load(&thread->bench->peak);
+        while (current > peak && !atomic_compare_exchange_weak(&thread->bench->peak, &peak, current)) { }
+    }
+}
+
+static void* bench_alloc(bench_thread_t* thread, size_t size)
+{
+    uint64_t start = (++thread->ops & LATENCY_SAMPLE_MASK) == 0 ? now_ns() : 0;
+
+    void* ptr = thread->bench->allocator->libmem ? mem_alloc(size) : malloc(size);
+
+    sample(thread, start);
+
+    if (ptr == NULL) {
+        thread->failed++;
+    } else {
+        *(char*)ptr = 1;
+    }
+
+    return ptr;
+}
+
+static void bench_free(bench_thread_t* thread, void* ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+
+    uint64_t start = (++thread->ops & LATENCY_SAMPLE_MASK) == 0 ? now_ns() : 0;
+
+    if (thread->bench->allocator->libmem) {
+        mem_free(ptr);
+    } else {
+        free(ptr);
+    }
+
+    sample(thread, start);
+}
+
+static size_t random_size(bench_thread_t* thread, size_t min, size_t max)
+{
+    return min + (size_t)rand_r(&thread->seed) % (max - min + 1);
+}
+
+/**
+ * @brief Empile puis dépile des allocations, en ordre LIFO.
+ */
+static void workload_lifo(bench_thread_t* thread)
+{
+    while (thread->ops < thread->bench->ops) {
+        for (size_t i = 0; i < LIFO_DEPTH; ++i) {
+            thread->slots[i] = bench_alloc(thread, random_size(thread, 8, 256));
+        }
+
+        for (size_t i = LIFO_DEPTH; i > 0; --i) {
+            bench_free(thread, thread->slots[i - 1]);
+            thread->slots[i - 1] = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Alloue et libère des tailles aléatoires dans un ordre aléatoire.
+ */
+static void workload_random(bench_thread_t* thread)
+{
+    while (thread->ops < thread->bench->ops) {
+        size_t slot = (size_t)rand_r(&thread->seed) % thread->slot_count;
+
+        if (thread->slots[slot] == NULL) {
+            thread->slots[slot] = bench_alloc(thread, random_size(thread, 8, 512));
+        } else {
+            bench_free(thread, thread->slots[slot]);
+            thread->slots[slot] = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Les fils pairs allouent et les fils impairs libèrent ce que leur
+ * voisin a alloué, à travers un anneau par paire.
+ */
+static void workload_prodcons(bench_thread_t* thread)
+{
+    bench_t* bench = thread->bench;
+    size_t pair = thread->index / 2;
+
+    if (pair * 2 + 1 >= bench->threads) {
+        return;
+    }
+
+    void* _Atomic* ring = bench->rings + pair * RING_SIZE;
+    atomic_size_t* head = bench->ring_heads + pair;
+    atomic_size_t* tail = bench->ring_tails + pair;
+    size_t count = bench->ops / 2;
+
+    if (thread->index % 2 == 0) {
+        for (size_t i = 0; i < count; ++i) {
+            void* ptr = bench_alloc(thread, random_size(thread, 8, 512));
+
+            while (i - atomic_load(tail) >= RING_SIZE) {
+                sched_yield();
+            }
+
+            atomic_store(&ring[i % RING_SIZE], ptr);
+            atomic_store(head, i + 1);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            while (atomic_load(head) <= i) {
+                sched_yield();
+            }
+
+            bench_free(thread, atomic_load(&ring[i % RING_SIZE]));
+            atomic_store(tail, i + 1);
+        }
+    }
+}
+
+/**
+ * @brief Simulation d'un serveur à la Larson: chaque fil remplace des objets
+ * aléatoires dans sa partition, puis la partition passe au fil suivant, qui
+ * libère donc des objets alloués ailleurs.
+ */
+static void workload_larson(bench_thread_t* thread)
+{
+    bench_t* bench = thread->bench;
+    size_t partition = thread->index;
+
+    for (size_t round = 0; round * LARSON_ROUND * 2 < bench->ops; ++round) {
+        void** slots = bench->shared_slots + partition * SLOTS;
+
+        for (size_t i = 0; i < LARSON_ROUND; ++i) {
+            size_t slot = (size_t)rand_r(&thread->seed) % SLOTS;
+            bench_free(thread, slots[slot]);
+            slots[slot] = bench_alloc(thread, random_size(thread, 8, 256));
+        }
+
+        pthread_barrier_wait(&bench->round);
+        partition = (partition + 1) % bench->threads;
+    }
+}
+
+/**
+ * @brief Comme `random`, mais une allocation sur seize est un gros tampon.
+ */
+static void workload_large(bench_thread_t* thread)
+{
+    while (thread->ops < thread->bench->ops) {
+        size_t slot = (size_t)rand_r(&thread->seed) % thread->slot_count;
+
+        if (thread->slots[slot] == NULL) {
+            size_t size = rand_r(&thread->seed) % 16 == 0 ? random_size(thread, 32 * 1024, 512 * 1024) : random_size(thread, 8, 512);
+            thread->slots[slot] = bench_alloc(thread, size);
+        } else {
+            bench_free(thread, thread->slots[slot]);
+            thread->slots[slot] = NULL;
+        }
+    }
+}
+
+/**
+ * @brief Fait croître l'ensemble de travail jusqu'à sa taille maximale, puis le
+ * réduit au huitième, en boucle.
+ */
+static void workload_working_set(bench_thread_t* thread)
+{
+    size_t live = 0;
+
+    while (thread->ops < thread->bench->ops) {
+        for (; live < thread->slot_count; ++live) {
+            thread->slots[live] = bench_alloc(thread, random_size(thread, 64, 4096));
+        }
+
+        while (live > thread->slot_count / 8) {
+            size_t slot = (size_t)rand_r(&thread->seed) % live;
+            bench_free(thread, thread->slots[slot]);
+            thread->slots[slot] = thread->slots[--live];
+            thread->slots[live] = NULL;
+        }
+    }
+}
+
+typedef struct workload_entry {
+    const char* name;
+    workload_t* workload;
+} workload_entry_t;
+
+static const workload_entry_t workloads[] = {
+    { "lifo", workload_lifo },
+    { "random", workload_random },
+    { "prodcons", workload_prodcons },
+    { "larson", workload_larson },
+    { "working-set", workload_working_set },
+    { "large", workload_large },
+    { NULL, NULL },
+};
+
+static void* bench_thread_main(void* arg)
+{
+    bench_thread_t* thread = arg;
+
+    pthread_barrier_wait(&thread->bench->start);
+    thread->start = now_ns();
+    thread->bench->workload(thread);
+    thread->end = now_ns();
+
+    return NULL;
+}
+
+/**
+ * @brief Lit les statistiques de libmem à intervalle régulier, comme le ferait
+ * un exportateur de métriques, jusqu'à la fin de la mesure.
+ */
+static void* bench_monitor_main(void* arg)
+{
+    bench_t* bench = arg;
+    struct timespec period = {
+        .tv_sec = (time_t)(options.monitor / 1000000),
+        .tv_nsec = (long)(options.monitor % 1000000) * 1000,
+    };
+
+    while (!atomic_load(&bench->stop)) {
+        mem_stats_t stats;
+        mem_get_stats(&stats);
+        nanosleep(&period, NULL);
+    }
+
+    return NULL;
+}
+
+static int compare_u64(const void* lhs, const void* rhs)
+{
+    uint64_t a = *(const uint64_t*)lhs;
+    uint64_t b = *(const uint64_t*)rhs;
+    return (a > b) - (a < b);
+}
+
+static uint64_t percentile(const uint64_t* values, size_t count, double p)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    size_t index = (size_t)(p * (double)(count - 1));
+    return values[index];
+}
+
+static void run(const workload_entry_t* workload, const allocator_t* allocator)
+{
+    bench_t bench = {
+        .allocator = allocator,
+        .workload = workload->workload,
+        .threads = options.threads,
+        .ops = options.ops,
+    };
+    atomic_init(&bench.peak, 0);
+    atomic_init(&bench.stop, false);
+
+    bench_thread_t* threads = calloc(options.threads, sizeof(*threads));
+    pthread_t* ids = calloc(options.threads, sizeof(*ids));
+    bench.shared_slots = calloc(options.threads * SLOTS, sizeof(void*));
+    bench.rings = calloc(options.threads * RING_SIZE, sizeof(*bench.rings));
+    bench.ring_heads = calloc(options.threads, sizeof(*bench.ring_heads));
+    bench.ring_tails = calloc(options.threads, sizeof(*bench.ring_tails));
+    if (threads == NULL || ids == NULL || bench.shared_slots == NULL || bench.rings == NULL
+        || bench.ring_heads == NULL || bench.ring_tails == NULL) {
+        ERROR("failed to allocate benchmark state");
+    }
+
+    if (allocator->libmem && !mem_init_ex(options.size, allocator->strategy, &options.heap)) {
+        ERROR("failed to create heap");
+    }
+
+    pthread_barrier_init(&bench.start, NULL, options.threads + 1);
+    pthread_barrier_init(&bench.round, NULL, options.threads);
+
+    for (size_t i = 0; i < options.threads; ++i) {
+        bench_thread_t* thread = &threads[i];
+        thread->bench = &bench;
+        thread->index = i;
+        thread->seed = options.seed + (unsigned int)i;
+        thread->slot_count = SLOTS;
+        thread->slots = calloc(SLOTS, sizeof(void*));
+        thread->latency_capacity = options.ops / (LATENCY_SAMPLE_MASK + 1) * 2 + 1;
+        thread->latencies = calloc(thread->latency_capacity, sizeof(uint64_t));
+        if (thread->slots == NULL || thread->latencies == NULL) {
+            ERROR("failed to allocate benchmark state");
+        }
+
+        if (pthread_create(&ids[i], NULL, bench_thread_main, thread) != 0) {
+            ERROR("failed to create thread");
+        }
+    }
+
+    pthread_t monitor;
+    bool monitoring = allocator->libmem && options.monitor != 0;
+    if (monitoring && pthread_create(&monitor, NULL, bench_monitor_main, &bench) != 0) {
+        ERROR("failed to create thread");
+    }
+
+    pthread_barrier_wait(&bench.start);
+
+    for (size_t i = 0; i < options.threads; ++i) {
+        pthread_join(ids[i], NULL);
+    }
+
+    if (monitoring) {
+        atomic_store(&bench.stop, true);
+        pthread_join(monitor, NULL);
+    }
+
+    uint64_t start = UINT64_MAX;
+    uint64_t end = 0;
+    size_t ops = 0;
+    size_t failed = 0;
+    size_t latency_count = 0;
+    for (size_t i = 0; i < options.threads; ++i) {
+        start = threads[i].start < start ? threads[i].start : start;
+        end = threads[i].end > end ? threads[i].end : end;
+        ops += threads[i].ops;
+        failed += threads[i].failed;
+        latency_count += threads[i].latency_count;
+    }
+
+    uint64_t* latencies = calloc(latency_count + 1, sizeof(uint64_t));
+    if (latencies == NULL) {
+        ERROR("failed to allocate benchmark state");
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < options.threads; ++i) {
+        memcpy(latencies + offset, threads[i].latencies, threads[i].latency_count * sizeof(uint64_t));
+        offset += threads[i].latency_count;
+    }
+    qsort(latencies, latency_count, sizeof(uint64_t), compare_u64);
+
+    size_t peak = atomic_load(&bench.peak);
+    size_t current = footprint(allocator);
+    if (current > peak) {
+        peak = current;
+    }
+
+    double fragmentation = NAN;
+    double small_free_blocks = NAN;
+    double switches = NAN;
+    if (allocator->libmem) {
+        switches = (double)mem_get_strategy_switch_count();
+        small_free_blocks = (double)mem_count_small_free_blocks(SMALL_FREE_BLOCK_SIZE);
+        size_t free_bytes = mem_get_free_bytes();
+        size_t biggest = mem_get_biggest_free_block_size();
+        fragmentation = free_bytes == 0 ? 0.0 : 1.0 - (double)biggest / (double)free_bytes;
+    }
+
+    double seconds = (double)(end - start) / 1e9;
+    printf("%s,%s,%zu,%zu,%.6f,%.0f,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%zu,%.4f,%.0f,%.0f,%zu\n",
+        workload->name, allocator->name, options.threads, ops, seconds, (double)ops / seconds,
+        percentile(latencies, latency_count, 0.50),
+        percentile(latencies, latency_count, 0.99),
+        percentile(latencies, latency_count, 0.999),
+        peak, fragmentation, small_free_blocks, switches, failed);
+    (void)fflush(stdout);
+
+    // Les objets encore vivants ne sont libérés que pour `malloc`: le tas de
+    // libmem est détruit d'un coup.
+    for (size_t i = 0; i < options.threads; ++i) {
+        if (!allocator->libmem) {
+            for (size_t slot = 0; slot < SLOTS; ++slot) {
+                free(threads[i].slots[slot]);
+                free(bench.shared_slots[i * SLOTS + slot]);
+            }
+        }
+
+        free(threads[i].slots);
+        free(threads[i].latencies);
+    }
+
+    if (allocator->libmem) {
+        mem_deinit();
+    }
+
+    pthread_barrier_destroy(&bench.round);
+    pthread_barrier_destroy(&bench.start);
+    free(latencies);
+    free(bench.ring_tails);
+    free(bench.ring_heads);
+    free(bench.rings);
+    free(bench.shared_slots);
+    free(ids);
+    free(threads);
+}
+
+int main(int argc, char** argv)
+{
+    parse_options(argc, argv);
+
+    printf("workload,allocator,threads,ops,seconds,ops_per_sec,p50_ns,p99_ns,p999_ns,peak_bytes,fragmentation,small_free_blocks,switches,failed\n");
+
+    for (const workload_entry_t* workload = workloads; workload->name != NULL; workload++) {
+        if (options.workload != NULL && strcmp(options.workload, workload->name) != 0) {
+            continue;
+        }
+
+        for (const allocator_t* allocator = allocators; allocator->name != NULL; allocator++) {
+            if (options.allocator != NULL && strcmp(options.allocator, allocator->name) != 0) {
+                continue;
+            }
+
+            run(workload, allocator);
+        }
+    }
+
+    return 0;
+}
+
+static void parse_options(int argc, char** argv)
+{
+    static const char* shortopts = ":n:t:o:r:w:a:m:R:yil:p:M:h";
+    static const struct option longopts[] = {
+        { "size", required_argument, NULL, 'n' },
+        { "threads", required_argument, NULL, 't' },
+        { "ops", required_argument, NULL, 'o' },
+        { "seed", required_argument, NULL, 'r' },
+        { "workload", required_argument, NULL, 'w' },
+        { "allocator", required_argument, NULL, 'a' },
+        { "min-split", required_argument, NULL, 'm' },
+        { "rounding", required_argument, NULL, 'R' },
+        { "async", no_argument, NULL, 'y' },
+        { "index", no_argument, NULL, 'i' },
+        { "mmap-threshold", required_argument, NULL, 'l' },
+        { "profile", required_argument, NULL, 'p' },
+        { "monitor", required_argument, NULL, 'M' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    typedef struct string_to_rounding {
+        const char* string;
+        mem_rounding_t rounding;
+    } string_to_rounding_t;
+
+    static const string_to_rounding_t roundings[] = {
+        { "none", MEM_ROUND_NONE },
+        { "16", MEM_ROUND_16 },
+        { "class", MEM_ROUND_SIZE_CLASS },
+        { NULL, 0 },
+    };
+
+    bool usage = false;
+
+    while (true) {
+        int code = getopt_long(argc, argv, shortopts, longopts, NULL);
+
+        if (code == -1) {
+            break;
+        }
+
+        switch (code) {
+        case 'n':
+        case 't':
+        case 'o':
+        case 'M':
+        case 'r': {
+            // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+            long value = atol(optarg);
+
+            if (value <= 0) {
+                usage = true;
+            } else if (code == 'n') {
+                options.size = (size_t)value;
+            } else if (code == 't') {
+                options.threads = (size_t)value;
+            } else if (code == 'o') {
+                options.ops = (size_t)value;
+            } else if (code == 'M') {
+                options.monitor = (size_t)value;
+            } else {
+                options.seed = (unsigned int)value;
+            }
+
+            break;
+        }
+        case 'w':
+            options.workload = optarg;
+            break;
+        case 'a':
+            options.allocator = optarg;
+            break;
+        case 'm': {
+            // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+            long min_split = atol(optarg);
+
+            if (min_split <= 0) {
+                usage = true;
+            } else {
+                options.heap.min_split = min_split;
+            }
+
+            break;
+        }
+        case 'p': {
+            // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+            long sample_bytes = atol(optarg);
+
+            if (sample_bytes <= 0) {
+                usage = true;
+            } else {
+                options.heap.profile_sample_bytes = sample_bytes;
+            }
+
+            break;
+        }
+        case 'R': {
+            const string_to_rounding_t* rounding_it = roundings;
+
+            while (rounding_it->string != NULL) {
+                if (strcasecmp(rounding_it->string, optarg) == 0) {
+                    break;
+                }
+
+                rounding_it++;
+            }
+
+            if (rounding_it->string == NULL) {
+                usage = true;
+            } else {
+                options.heap.rounding = rounding_it->rounding;
+            }
+
+            break;
+        }
+        case 'y':
+            options.heap.async_free = true;
+            break;
+        case 'i':
+            options.heap.block_index = true;
+            break;
+        case 'l': {
+            // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+            long threshold = atol(optarg);
+
+            if (threshold <= 0) {
+                usage = true;
+            } else {
+                options.heap.mmap_threshold = threshold;
+            }
+
+            break;
+        }
+        case 'h':
+        case '?':
+        case ':':
+            usage = true;
+            break;
+        default:
+            WARN("getopt_long returned an unknown character code: %c", code);
+            exit(EXIT_FAILURE);
+            return;
+        }
+    }
+
+    if (usage) {
+        printf(
+            "UTILISATION:\n"
+            "\n"
+            "\t%s [--size n] [--threads n] [--ops n] [--seed n] [--workload w] [--allocator a] [--min-split n] [--rounding none|16|class] [--async] [--index] [--mmap-threshold n] [--profile n] [--monitor us] [--help]\n"
+            "\n"
+            "DESCRIPTION:\n"
+            "\n"
+            "\tCompare les stratégies de libmem et `malloc` sur des charges de travail\n"
+            "\tstandards. Une ligne CSV est imprimée par charge et par allocateur.\n"
+            "\n"
+            "OPTIONS:\n"
+            "\n"
+            "\t--size <n>\n"
+            "\t\tLa taille du tas de libmem, en octets.\n"
+            "\n"
+            "\t--threads <n>\n"
+            "\t\tLe nombre de fils d'exécution.\n"
+            "\n"
+            "\t--ops <n>\n"
+            "\t\tLe nombre d'opérations par fil d'exécution.\n"
+            "\n"
+            "\t--seed <n>\n"
+            "\t\tLa graine des générateurs aléatoires.\n"
+            "\n"
+            "\t--workload lifo|random|prodcons|larson|working-set|large\n"
+            "\t\tN'exécute qu'une seule charge de travail.\n"
+            "\n"
+            "\t--allocator first-fit|best-fit|worst-fit|next-fit|adaptive|malloc\n"
+            "\t\tN'exécute qu'un seul allocateur.\n"
+            "\n"
+            "\t--min-split <n>\n"
+            "\t\tLa plus petite taille de bloc libre laissée par une division.\n"
+            "\n"
+            "\t--rounding none|16|class\n"
+            "\t\tArrondit chaque allocation au multiple de 16 ou à une classe de taille.\n"
+            "\n"
+            "\t--async\n"
+            "\t\tDélègue les libérations de libmem à un fil de récupération.\n"
+            "\n"
+            "\t--index\n"
+            "\t\tCherche les blocs libres de libmem dans un index vectorisé.\n"
+            "\n"
+            "\t--mmap-threshold <n>\n"
+            "\t\tProjette hors du tas de libmem toute allocation d'au moins n octets.\n"
+            "\n"
+            "\t--profile <n>\n"
+            "\t\tÉchantillonne une allocation de libmem environ tous les n octets.\n"
+            "\n"
+            "\t--monitor <us>\n"
+            "\t\tLit les statistiques de libmem toutes les us microsecondes depuis un autre fil.\n"
+            "\n"
+            "\t--help\n"
+            "\t\tAffiche ce message informatif.\n",
+            argv[0]);
+        exit(EXIT_FAILURE);
+    }
+}
@@ -1,8 +1,11 @@
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include <getopt.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <readline/history.h>
 #include <readline/readline.h>
@@ -13,6 +16,12 @@
 #define ALLOCATE_BYTE 0xFE
 #define PROBE_BYTE 0x42
 #define COUNT_SMALL_SIZE 16
+#define STRESS_LIVE_ALLOCATIONS 16
+#define STRESS_MAX_SIZE 64
+#define MAX_ARGS 8
+#define BATCH_BUFFER_SIZE (1 << 16)
+#define INITIAL_ALLOCATION_CAPACITY 64
+#define MAX_MARKS 16
 
 #define WARN(fmt, ...)                                                                 \
     do {                                                                               \
@@ -28,14 +37,51 @@
 struct {
     mem_strategy_t strategy;
     size_t size;
+    const char* file;
+    bool shared;
+    const char* batch;
+    bool quiet;
+    mem_options_t heap;
 } options = {
     .strategy = MEM_FIRST_FIT,
     .size = DEFAULT_SIZE,
+    .file = NULL,
+    .shared = false,
+    .batch = NULL,
+    .quiet = false,
+    .heap = { .min_split = 1, .rounding = MEM_ROUND_NONE },
 };
 
 static void parse_options(int argc, char** argv);
 static void print_state();
 
+typedef struct string_to_strategy {
+    const char* string;
+    mem_strategy_t strategy;
+} string_to_strategy_t;
+
+static const string_to_strategy_t strategies[] = {
+    { "first-fit", MEM_FIRST_FIT },
+    { "first", MEM_FIRST_FIT },
+    { "f", MEM_FIRST_FIT },
+    { "best-fit", MEM_BEST_FIT },
+    { "best", MEM_BEST_FIT },
+    { "b", MEM_BEST_FIT },
+    { "worst-fit", MEM_WORST_FIT },
+    { "worst", MEM_WORST_FIT },
+    { "w", MEM_WORST_FIT },
+    { "next-fit", MEM_NEXT_FIT },
+    { "next", MEM_NEXT_FIT },
+    { "n", MEM_NEXT_FIT },
+    { "adaptive", MEM_ADAPTIVE },
+    { "a", MEM_ADAPTIVE },
+    { "region", MEM_REGION },
+    { "r", MEM_REGION },
+    { NULL, 0 },
+};
+
+static const string_to_strategy_t* strategy_find(const char* string);
+
 typedef enum {
     CONTINUE,
     CONTINUE_WITH_STATE,
@@ -44,61 +90,149 @@ typedef enum {
 
 typedef continue_t(command_t)(int argc, char** argv);
 
+static continue_t handle_line(char* line);
+static void run_interactive(void);
+static void run_batch(const char* path);
 static continue_t handle_command(int argc, char** argv);
 static continue_t handle_allocate(int argc, char** argv);
 static continue_t handle_free(int argc, char** argv);
+static continue_t handle_reallocate(int argc, char** argv);
 static continue_t handle_exit();
 static continue_t handle_state();
 static continue_t handle_list(int argc, char** argv);
 static continue_t handle_probe(int argc, char** argv);
+static continue_t handle_stress(int argc, char** argv);
+static continue_t handle_strategy(int argc, char** argv);
+static continue_t handle_flush();
+static continue_t handle_profile(int argc, char** argv);
+static continue_t handle_mark();
+static continue_t handle_reset(int argc, char** argv);
 static continue_t handle_test();
 
 int main(int argc, char** argv)
 {
     parse_options(argc, argv);
 
-    mem_init(options.size, options.strategy);
+    if (options.shared) {
+        if (!mem_init_shared(NULL, options.size, options.strategy)) {
+            ERROR("failed to create shared heap");
+        }
+    } else if (options.file == NULL) {
+        if (!mem_init_ex(options.size, options.strategy, &options.heap)) {
+            ERROR("failed to create heap");
+        }
+    } else if (!mem_init_file(options.file, options.size, options.strategy)) {
+        ERROR("failed to open heap file: %s", options.file);
+    }
 
-    char* line;
-    while ((line = readline("Log710Test> ")) != NULL) {
-        HIST_ENTRY* entry = current_history();
-        if (entry == NULL || strcmp(entry->line, line) != 0) {
-            add_history(line);
+    if (options.batch == NULL) {
+        run_interactive();
+    } else {
+        run_batch(options.batch);
+    }
+
+    mem_deinit();
+
+    return 0;
+}
+
+/**
+ * @brief Découpe une ligne en arguments, en place.
+ *
+ * @return Le nombre d'arguments, ou -1 s'il y en a plus que `MAX_ARGS`
+ */
+static int tokenize(char* line, char** argv)
+{
+    int argc = 0;
+    char* it = line;
+
+    while (true) {
+        while (*it == ' ' || *it == '\t' || *it == '\n' || *it == '\r') {
+            it++;
+        }
+
+        if (*it == '\0') {
+            break;
         }
 
-        int argc = 0;
-        for (char* it = strtok(line, " "); it != NULL; it = strtok(NULL, " ")) {
-            argc++;
+        if (argc == MAX_ARGS) {
+            return -1;
         }
 
-        char** argv = malloc(sizeof(*argv) * (argc + 1));
-        if (argv == NULL) {
-            mem_deinit();
-            ERROR("failed to allocate argv");
+        argv[argc++] = it;
+
+        while (*it != '\0' && *it != ' ' && *it != '\t' && *it != '\n' && *it != '\r') {
+            it++;
         }
 
-        char* arg = line;
-        for (int i = 0; i < argc; ++i) {
-            argv[i] = arg;
-            arg += strlen(arg) + 1;
+        if (*it != '\0') {
+            *it++ = '\0';
         }
+    }
 
-        continue_t result = handle_command(argc, argv);
-        if (result == CONTINUE_WITH_STATE) {
-            print_state();
+    argv[argc] = NULL;
+    return argc;
+}
+
+static continue_t handle_line(char* line)
+{
+    char* argv[MAX_ARGS + 1];
+    int argc = tokenize(line, argv);
+
+    if (argc < 0) {
+        puts("trop d'arguments");
+        return CONTINUE;
+    }
+
+    continue_t result = handle_command(argc, argv);
+    if (result == CONTINUE_WITH_STATE && !options.quiet) {
+        print_state();
+    }
+
+    return result;
+}
+
+static void run_interactive(void)
+{
+    char* line;
+    while ((line = readline("Log710Test> ")) != NULL) {
+        HIST_ENTRY* entry = current_history();
+        if (entry == NULL || strcmp(entry->line, line) != 0) {
+            add_history(line);
         }
 
-        free(argv);
+        continue_t result = handle_line(line);
         free(line);
 
         if (result == EXIT) {
             break;
         }
     }
+}
 
-    mem_deinit();
+static void run_batch(const char* path)
+{
+    FILE* input = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (input == NULL) {
+        mem_deinit();
+        ERROR("failed to open script: %s", path);
+    }
 
-    return 0;
+    (void)setvbuf(input, NULL, _IOFBF, BATCH_BUFFER_SIZE);
+    (void)setvbuf(stdout, NULL, _IOFBF, BATCH_BUFFER_SIZE);
+
+    char* line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, input) != -1) {
+        if (handle_line(line) == EXIT) {
+            break;
+        }
+    }
+
+    free(line);
+    if (input != stdin) {
+        (void)fclose(input);
+    }
 }
 
 static continue_t handle_command(int argc, char** argv)
@@ -113,6 +247,8 @@ static continue_t handle_command(int argc, char** argv)
         { "A", handle_allocate },
         { "FREE", handle_free },
         { "F", handle_free },
+        { "REALLOCATE", handle_reallocate },
+        { "R", handle_reallocate },
         { "EXIT", handle_exit },
         { "E", handle_exit },
         { "STATE", handle_state },
@@ -121,6 +257,18 @@ static continue_t handle_command(int argc, char** argv)
         { "L", handle_list },
         { "PROBE", handle_probe },
         { "P", handle_probe },
+        { "STRESS", handle_stress },
+        { "X", handle_stress },
+        { "STRATEGY", handle_strategy },
+        { "M", handle_strategy },
+        { "FLUSH", handle_flush },
+        { "W", handle_flush },
+        { "PROFILE", handle_profile },
+        { "O", handle_profile },
+        { "MARK", handle_mark },
+        { "K", handle_mark },
+        { "RESET", handle_reset },
+        { "Z", handle_reset },
         { "T", handle_test},
         { NULL, NULL }
     };
@@ -140,15 +288,28 @@ static continue_t handle_command(int argc, char** argv)
 }
 
 typedef struct allocation {
-    size_t id;
-    struct allocation* next;
     void* ptr;
     size_t size;
 } allocation_t;
 
+// NOTE: Les allocations sont indexées par leur identifiant; une allocation
+// libérée garde sa case avec un pointeur nul.
 static size_t allocation_id_sequence = 0;
+static size_t allocation_capacity = 0;
 static allocation_t* allocations = NULL;
 
+static mem_mark_t marks[MAX_MARKS];
+static size_t mark_count = 0;
+
+static allocation_t* allocation_find(size_t id)
+{
+    if (id == 0 || id > allocation_id_sequence || allocations[id].ptr == NULL) {
+        return NULL;
+    }
+
+    return &allocations[id];
+}
+
 static continue_t handle_allocate(int argc, char** argv)
 {
     bool usage = false;
@@ -158,7 +319,7 @@ static continue_t handle_allocate(int argc, char** argv)
     }
 
     // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
-    long size = atol(argv[1]);
+    long size = usage ? 0 : atol(argv[1]);
     if (size <= 0) {
         usage = true;
     }
@@ -182,20 +343,24 @@ static continue_t handle_allocate(int argc, char** argv)
         return CONTINUE;
     }
 
-    allocation_t* allocation = malloc(sizeof(*allocation));
-    if (allocation == NULL) {
-        ERROR("failed to allocate memory for persisting allocation");
+    if (allocation_id_sequence + 1 >= allocation_capacity) {
+        size_t capacity = allocation_capacity == 0 ? INITIAL_ALLOCATION_CAPACITY : allocation_capacity * 2;
+        allocation_t* resized = realloc(allocations, capacity * sizeof(*allocations));
+        if (resized == NULL) {
+            ERROR("failed to allocate memory for persisting allocation");
+        }
+
+        allocations = resized;
+        allocation_capacity = capacity;
     }
 
     memset(ptr, ALLOCATE_BYTE, size);
 
-    allocation->id = ++allocation_id_sequence;
-    allocation->ptr = ptr;
-    allocation->next = allocations;
-    allocation->size = size;
-    allocations = allocation;
+    size_t id = ++allocation_id_sequence;
+    allocations[id].ptr = ptr;
+    allocations[id].size = size;
 
-    printf("ALLOCATION: %zu\n", allocation->id);
+    printf("ALLOCATION: %zu\n", id);
 
     return CONTINUE_WITH_STATE;
 }
@@ -209,7 +374,7 @@ static continue_t handle_free(int argc, char** argv)
     }
 
     // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
-    long identifier = atol(argv[1]);
+    long identifier = usage ? 0 : atol(argv[1]);
     if (identifier <= 0) {
         usage = true;
     }
@@ -226,30 +391,68 @@ static continue_t handle_free(int argc, char** argv)
         return CONTINUE;
     }
 
-    allocation_t* current = allocations;
-    allocation_t* previous = NULL;
+    allocation_t* allocation = allocation_find((size_t)identifier);
+    if (allocation == NULL) {
+        printf("aucune allocation avec l'identifiant: %ld\n", identifier);
+        return CONTINUE;
+    }
 
-    while (current != NULL) {
-        if (current->id == (size_t)identifier) {
-            mem_free(current->ptr);
-            allocation_t* next = current->next;
-            free(current);
+    mem_free(allocation->ptr);
+    allocation->ptr = NULL;
 
-            if (previous == NULL) {
-                allocations = next;
-            } else {
-                previous->next = next;
-            }
+    return CONTINUE_WITH_STATE;
+}
 
-            return CONTINUE_WITH_STATE;
-        }
+static continue_t handle_reallocate(int argc, char** argv)
+{
+    bool usage = false;
 
-        previous = current;
-        current = current->next;
+    if (argc != 3) {
+        usage = true;
     }
 
-    printf("aucune allocation avec l'identifiant: %zu\n", identifier);
-    return CONTINUE;
+    // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+    long identifier = usage ? 0 : atol(argv[1]);
+    // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+    long size = usage ? 0 : atol(argv[2]);
+    if (identifier <= 0 || size <= 0) {
+        usage = true;
+    }
+
+    if (usage) {
+        printf(
+            "UTILISATION:\n"
+            "\t%s <i> <n>\n"
+            "\n"
+            "ARGUMENTS:\n"
+            "\n"
+            "\t<i> - L'identifiant de l'allocation à redimensionner.\n"
+            "\t<n> - La nouvelle taille de l'allocation en octets.\n",
+            argv[0]);
+        return CONTINUE;
+    }
+
+    allocation_t* allocation = allocation_find((size_t)identifier);
+    if (allocation == NULL) {
+        printf("aucune allocation avec l'identifiant: %ld\n", identifier);
+        return CONTINUE;
+    }
+
+    void* ptr = mem_realloc(allocation->ptr, size);
+    if (ptr == NULL) {
+        puts("impossible d'allouer plus de mémoire");
+
+        return CONTINUE;
+    }
+
+    if ((size_t)size > allocation->size) {
+        memset((char*)ptr + allocation->size, ALLOCATE_BYTE, size - allocation->size);
+    }
+
+    allocation->ptr = ptr;
+    allocation->size = size;
+
+    return CONTINUE_WITH_STATE;
 }
 
 static continue_t handle_test()
@@ -259,6 +462,115 @@ static continue_t handle_test()
     return CONTINUE;
 }
 
+static continue_t handle_flush()
+{
+    mem_flush();
+    return CONTINUE_WITH_STATE;
+}
+
+static continue_t handle_profile(int argc, char** argv)
+{
+    mem_profile_t profile = MEM_PROFILE_LIVE;
+    bool usage = argc < 2 || argc > 3;
+
+    if (!usage && argc == 3) {
+        if (strcasecmp(argv[2], "total") == 0) {
+            profile = MEM_PROFILE_CUMULATIVE;
+        } else if (strcasecmp(argv[2], "live") != 0) {
+            usage = true;
+        }
+    }
+
+    if (usage) {
+        printf(
+            "UTILISATION:\n"
+            "\t%s <path> [live|total]\n"
+            "\n"
+            "ARGUMENTS:\n"
+            "\n"
+            "\t<path>       - Le fichier où écrire le profil.\n"
+            "\t[live|total] - Les octets encore alloués (par défaut) ou tous les\n"
+            "\t               octets alloués depuis le début.\n",
+            argv[0]);
+        return CONTINUE;
+    }
+
+    if (!mem_profile_dump(argv[1], profile)) {
+        printf("impossible d'écrire le profil: %s\n", argv[1]);
+    }
+
+    return CONTINUE;
+}
+
+static continue_t handle_mark()
+{
+    if (mem_get_strategy() != MEM_REGION) {
+        puts("MARK exige la stratégie region");
+        return CONTINUE;
+    }
+
+    if (mark_count == MAX_MARKS) {
+        printf("trop de marques (maximum: %d)\n", MAX_MARKS);
+        return CONTINUE;
+    }
+
+    marks[mark_count++] = mem_mark();
+    printf("MARQUE: %zu\n", mark_count);
+
+    return CONTINUE;
+}
+
+static continue_t handle_reset(int argc, char** argv)
+{
+    // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+    long mark = argc == 2 ? atol(argv[1]) : 0;
+
+    if (argc > 2 || (argc == 2 && (mark <= 0 || (size_t)mark > mark_count))) {
+        printf(
+            "UTILISATION:\n"
+            "\t%s [k]\n"
+            "\n"
+            "ARGUMENTS:\n"
+            "\n"
+            "\t[k] - La marque à laquelle revenir; sans marque, libère tout le tas.\n",
+            argv[0]);
+        return CONTINUE;
+    }
+
+    size_t offset = 0;
+    if (mark == 0) {
+        mem_reset();
+        mark_count = 0;
+    } else {
+        if (mem_get_strategy() != MEM_REGION) {
+            puts("RESET <k> exige la stratégie region");
+            return CONTINUE;
+        }
+
+        if (!mem_reset_to(marks[mark - 1])) {
+            printf("la marque %ld est caduque\n", mark);
+            return CONTINUE;
+        }
+        offset = marks[mark - 1].offset;
+        mark_count = (size_t)mark;
+    }
+
+    // NOTE: Les allocations du tas au-delà de la marque n'existent plus; les
+    // grosses allocations, projetées hors du tas, restent. `mem_from_offset(0)`
+    // est nul, d'où le détour par le premier octet.
+    uintptr_t heap = (uintptr_t)mem_from_offset(1) - 1;
+    uintptr_t begin = heap + offset;
+    uintptr_t end = heap + options.size;
+    for (size_t id = 1; id <= allocation_id_sequence; ++id) {
+        uintptr_t ptr = (uintptr_t)allocations[id].ptr;
+        if (ptr >= begin && ptr < end) {
+            allocations[id].ptr = NULL;
+        }
+    }
+
+    return CONTINUE_WITH_STATE;
+}
+
 static continue_t handle_exit()
 {
     return EXIT;
@@ -266,7 +578,8 @@ static continue_t handle_exit()
 
 static continue_t handle_state()
 {
-    return CONTINUE_WITH_STATE;
+    print_state();
+    return CONTINUE;
 }
 
 static continue_t handle_list(int argc, char** argv)
@@ -285,11 +598,16 @@ static continue_t handle_list(int argc, char** argv)
         return CONTINUE;
     }
 
-    for (allocation_t* allocation = allocations; allocation != NULL; allocation = allocation->next) {
+    for (size_t id = allocation_id_sequence; id > 0; --id) {
+        allocation_t* allocation = allocation_find(id);
+        if (allocation == NULL) {
+            continue;
+        }
+
         void* begin = allocation->ptr;
         void* end = (char*)begin + allocation->size;
 
-        printf("[%zu] %p .. %p (size = %zu)\n", allocation->id, begin, end, allocation->size);
+        printf("[%zu] %p .. %p (size = %zu)\n", id, begin, end, allocation->size);
     }
 
     return CONTINUE;
@@ -341,34 +659,252 @@ static continue_t handle_probe(int argc, char** argv)
     return CONTINUE;
 }
 
+typedef struct stress_handoff {
+    size_t offset;
+    size_t size;
+    unsigned char byte;
+} stress_handoff_t;
+
+static bool stress_check(const unsigned char* ptr, size_t size, unsigned char byte)
+{
+    for (size_t i = 0; i < size; ++i) {
+        if (ptr[i] != byte) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int stress_child(unsigned int seed, long iterations, int fd)
+{
+    unsigned char* live[STRESS_LIVE_ALLOCATIONS] = { NULL };
+    size_t sizes[STRESS_LIVE_ALLOCATIONS] = { 0 };
+    unsigned char bytes[STRESS_LIVE_ALLOCATIONS] = { 0 };
+    bool ok = true;
+
+    for (long i = 0; i < iterations; ++i) {
+        size_t slot = (size_t)rand_r(&seed) % STRESS_LIVE_ALLOCATIONS;
+
+        if (live[slot] != NULL) {
+            ok = stress_check(live[slot], sizes[slot], bytes[slot]) && ok;
+            mem_free(live[slot]);
+            live[slot] = NULL;
+            continue;
+        }
+
+        size_t size = 1 + (size_t)rand_r(&seed) % STRESS_MAX_SIZE;
+        unsigned char* ptr = mem_alloc(size);
+        if (ptr == NULL) {
+            continue;
+        }
+
+        bytes[slot] = (unsigned char)rand_r(&seed);
+        sizes[slot] = size;
+        live[slot] = ptr;
+        memset(ptr, bytes[slot], size);
+    }
+
+    // Les allocations restantes sont remises au parent par leur décalage.
+    for (size_t slot = 0; slot < STRESS_LIVE_ALLOCATIONS; ++slot) {
+        if (live[slot] == NULL) {
+            continue;
+        }
+
+        ok = stress_check(live[slot], sizes[slot], bytes[slot]) && ok;
+
+        stress_handoff_t handoff = {
+            .offset = mem_to_offset(live[slot]),
+            .size = sizes[slot],
+            .byte = bytes[slot],
+        };
+        if (write(fd, &handoff, sizeof(handoff)) != sizeof(handoff)) {
+            ok = false;
+        }
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static continue_t handle_stress(int argc, char** argv)
+{
+    bool usage = false;
+
+    if (argc != 3) {
+        usage = true;
+    }
+
+    // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+    long processes = usage ? 0 : atol(argv[1]);
+    // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+    long iterations = usage ? 0 : atol(argv[2]);
+    if (processes <= 0 || iterations <= 0) {
+        usage = true;
+    }
+
+    if (usage) {
+        printf(
+            "UTILISATION:\n"
+            "\t%s <p> <n>\n"
+            "\n"
+            "ARGUMENTS:\n"
+            "\n"
+            "\t<p> - Le nombre de processus enfants.\n"
+            "\t<n> - Le nombre d'opérations par processus.\n",
+            argv[0]);
+        return CONTINUE;
+    }
+
+    if (!options.shared) {
+        puts("STRESS nécessite un tas partagé (--shared)");
+        return CONTINUE;
+    }
+
+    // NOTE: En région, les libérations dans le désordre sont différées; les
+    // blocs des enfants resteraient alloués et le bilan serait faux.
+    if (mem_get_strategy() == MEM_REGION) {
+        puts("STRESS n'est pas compatible avec la stratégie region");
+        return CONTINUE;
+    }
+
+    size_t allocated = mem_get_allocated_block_count();
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        ERROR("failed to create pipe");
+    }
+
+    (void)fflush(stdout);
+
+    for (long i = 0; i < processes; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            ERROR("failed to fork");
+        }
+
+        if (pid == 0) {
+            close(fds[0]);
+            _exit(stress_child((unsigned int)(i + 1), iterations, fds[1]));
+        }
+    }
+
+    close(fds[1]);
+
+    size_t handoffs = 0;
+    size_t failures = 0;
+    stress_handoff_t handoff;
+
+    while (read(fds[0], &handoff, sizeof(handoff)) == sizeof(handoff)) {
+        unsigned char* ptr = mem_from_offset(handoff.offset);
+        if (!mem_is_allocated(ptr) || !stress_check(ptr, handoff.size, handoff.byte)) {
+            failures++;
+        }
+
+        mem_free(ptr);
+        handoffs++;
+    }
+
+    close(fds[0]);
+
+    for (long i = 0; i < processes; ++i) {
+        int status;
+        if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            failures++;
+        }
+    }
+
+    if (mem_get_allocated_block_count() != allocated) {
+        failures++;
+    }
+
+    printf("STRESS: %s (%zu remises, %zu erreurs)\n", failures == 0 ? "SUCCES" : "ECHEC", handoffs, failures);
+
+    return CONTINUE_WITH_STATE;
+}
+
+static const string_to_strategy_t* strategy_find(const char* string)
+{
+    for (const string_to_strategy_t* it = strategies; it->string != NULL; it++) {
+        if (strcasecmp(it->string, string) == 0) {
+            return it;
+        }
+    }
+
+    return NULL;
+}
+
+static const char* strategy_name(mem_strategy_t strategy)
+{
+    for (const string_to_strategy_t* it = strategies; it->string != NULL; it++) {
+        if (it->strategy == strategy) {
+            return it->string;
+        }
+    }
+
+    return "?";
+}
+
+static continue_t handle_strategy(int argc, char** argv)
+{
+    const string_to_strategy_t* strategy = argc == 2 ? strategy_find(argv[1]) : NULL;
+
+    if (argc > 2 || (argc == 2 && strategy == NULL)) {
+        printf(
+            "UTILISATION:\n"
+            "\t%s [s]\n"
+            "\n"
+            "ARGUMENTS:\n"
+            "\n"
+            "\t[s] - La nouvelle stratégie: first-fit, best-fit, worst-fit, next-fit,\n"
+            "\t      adaptive ou region.\n",
+            argv[0]);
+        return CONTINUE;
+    }
+
+    if (strategy != NULL) {
+        mem_set_strategy(strategy->strategy);
+    }
+
+    mem_strategy_switch_t switches[16];
+    size_t count = mem_get_strategy_switches(switches, sizeof(switches) / sizeof(*switches));
+
+    printf("STRATEGIE: %s (%zu changements)\n", strategy_name(mem_get_strategy()), mem_get_strategy_switch_count());
+    for (size_t i = 0; i < count; ++i) {
+        printf("[%zu] %s -> %s\n", switches[i].allocation, strategy_name(switches[i].from), strategy_name(switches[i].to));
+    }
+
+    return CONTINUE;
+}
+
 static void parse_options(int argc, char** argv)
 {
-    static const char* shortopts = ":s:n:h";
+    static const char* shortopts = ":s:n:f:Sb:qm:R:yil:p:h";
     static const struct option longopts[] = {
         { "strategy", required_argument, NULL, 's' },
         { "size", required_argument, NULL, 'n' },
+        { "file", required_argument, NULL, 'f' },
+        { "shared", no_argument, NULL, 'S' },
+        { "batch", required_argument, NULL, 'b' },
+        { "quiet", no_argument, NULL, 'q' },
+        { "min-split", required_argument, NULL, 'm' },
+        { "rounding", required_argument, NULL, 'R' },
+        { "async", no_argument, NULL, 'y' },
+        { "index", no_argument, NULL, 'i' },
+        { "mmap-threshold", required_argument, NULL, 'l' },
+        { "profile", required_argument, NULL, 'p' },
         { "help", no_argument, NULL, 'h' },
         { NULL, 0, NULL, 0 }
     };
 
-    typedef struct string_to_strategy {
+    typedef struct string_to_rounding {
         const char* string;
-        mem_strategy_t strategy;
-    } string_to_strategy_t;
-
-    static const string_to_strategy_t strategies[] = {
-        { "first-fit", MEM_FIRST_FIT },
-        { "first", MEM_FIRST_FIT },
-        { "f", MEM_FIRST_FIT },
-        { "best-fit", MEM_BEST_FIT },
-        { "best", MEM_BEST_FIT },
-        { "b", MEM_BEST_FIT },
-        { "worst-fit", MEM_WORST_FIT },
-        { "worst", MEM_WORST_FIT },
-        { "w", MEM_WORST_FIT },
-        { "next-fit", MEM_NEXT_FIT },
-        { "next", MEM_NEXT_FIT },
-        { "n", MEM_NEXT_FIT },
+        mem_rounding_t rounding;
+    } string_to_rounding_t;
+
+    static const string_to_rounding_t roundings[] = {
+        { "none", MEM_ROUND_NONE },
+        { "16", MEM_ROUND_16 },
+        { "class", MEM_ROUND_SIZE_CLASS },
         { NULL, 0 },
     };
 
@@ -383,17 +919,9 @@ static void parse_options(int argc, char** argv)
 
         switch (code) {
         case 's': {
-            const string_to_strategy_t* strategy_it = strategies;
-
-            while (strategy_it->string != NULL) {
-                if (strcasecmp(strategy_it->string, optarg) == 0) {
-                    break;
-                }
-
-                strategy_it++;
-            }
+            const string_to_strategy_t* strategy_it = strategy_find(optarg);
 
-            if (strategy_it->string == NULL) {
+            if (strategy_it == NULL) {
                 usage = true;
             } else {
                 options.strategy = strategy_it->strategy;
@@ -413,6 +941,85 @@ static void parse_options(int argc, char** argv)
 
             break;
         }
+        case 'f':
+            options.file = optarg;
+
+            break;
+        case 'S':
+            options.shared = true;
+
+            break;
+        case 'b':
+            options.batch = optarg;
+
+            break;
+        case 'q':
+            options.quiet = true;
+
+            break;
+        case 'y':
+            options.heap.async_free = true;
+
+            break;
+        case 'i':
+            options.heap.block_index = true;
+
+            break;
+        case 'm': {
+            // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+            long min_split = atol(optarg);
+
+            if (min_split <= 0) {
+                usage = true;
+            } else {
+                options.heap.min_split = min_split;
+            }
+
+            break;
+        }
+        case 'l': {
+            // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+            long threshold = atol(optarg);
+
+            if (threshold <= 0) {
+                usage = true;
+            } else {
+                options.heap.mmap_threshold = threshold;
+            }
+
+            break;
+        }
+        case 'p': {
+            // NOLINTNEXTLINE(cert-err34-c,clang-analyzer-core.CallAndMessage)
+            long sample_bytes = atol(optarg);
+
+            if (sample_bytes <= 0) {
+                usage = true;
+            } else {
+                options.heap.profile_sample_bytes = sample_bytes;
+            }
+
+            break;
+        }
+        case 'R': {
+            const string_to_rounding_t* rounding_it = roundings;
+
+            while (rounding_it->string != NULL) {
+                if (strcasecmp(rounding_it->string, optarg) == 0) {
+                    break;
+                }
+
+                rounding_it++;
+            }
+
+            if (rounding_it->string == NULL) {
+                usage = true;
+            } else {
+                options.heap.rounding = rounding_it->rounding;
+            }
+
+            break;
+        }
 
         case 'h':
         case '?':
@@ -431,7 +1038,7 @@ static void parse_options(int argc, char** argv)
         printf(
             "UTILISATION:\n"
             "\n"
-            "\t%s [--size n] [--strategy first-fit|best-fit|worst-fit|next-fit] [--help]\n"
+            "\t%s [--size n] [--strategy first-fit|best-fit|worst-fit|next-fit|adaptive|region] [--file path] [--shared] [--batch path] [--quiet] [--min-split n] [--rounding none|16|class] [--async] [--index] [--mmap-threshold n] [--profile n] [--help]\n"
             "\n"
             "DESCRIPTION:\n"
             "\n"
@@ -442,10 +1049,45 @@ static void parse_options(int argc, char** argv)
             "\t--size <n>\n"
             "\t\tIndique le nombre d'octets que sera géré par votre gestionnaire de mémoire.\n"
             "\n"
-            "\t--strategy first-fit|best-fit|worst-fit|next-fit\n"
+            "\t--strategy first-fit|best-fit|worst-fit|next-fit|adaptive|region\n"
             "\t\tIndique la stratégie d'allocation à utiliser.\n"
             "\t\tLa valeur par défaut est \"first-fit\".\n"
             "\n"
+            "\t--file <path>\n"
+            "\t\tUtilise un tas persistant adossé au fichier donné. Le fichier est créé\n"
+            "\t\ts'il n'existe pas, sinon le tas qu'il contient est validé et réouvert.\n"
+            "\t\tUn seul processus à la fois peut ouvrir le fichier.\n"
+            "\t\tUn tas laissé en plein milieu d'une opération est réparé; un fichier\n"
+            "\t\td'une autre version ou illisible est refusé et doit être supprimé.\n"
+            "\n"
+            "\t--shared\n"
+            "\t\tUtilise un tas en mémoire partagée, hérité par les processus enfants.\n"
+            "\n"
+            "\t--batch <path>\n"
+            "\t\tExécute les commandes du fichier donné (\"-\" pour l'entrée standard)\n"
+            "\t\tsans passer par readline.\n"
+            "\n"
+            "\t--quiet\n"
+            "\t\tN'affiche l'état du gestionnaire que sur demande, avec STATE.\n"
+            "\n"
+            "\t--min-split <n>\n"
+            "\t\tLa plus petite taille de bloc libre laissée par une division.\n"
+            "\n"
+            "\t--rounding none|16|class\n"
+            "\t\tArrondit chaque allocation au multiple de 16 ou à une classe de taille.\n"
+            "\n"
+            "\t--async\n"
+            "\t\tDélègue les libérations à un fil de récupération (voir FLUSH).\n"
+            "\n"
+            "\t--index\n"
+            "\t\tCherche les blocs libres dans un index vectorisé (tas anonyme seulement).\n"
+            "\n"
+            "\t--mmap-threshold <n>\n"
+            "\t\tProjette hors du tas toute allocation d'au moins n octets (tas anonyme seulement).\n"
+            "\n"
+            "\t--profile <n>\n"
+            "\t\tÉchantillonne une allocation environ tous les n octets (voir PROFILE).\n"
+            "\n"
             "\t--help\n"
             "\t\tAffiche ce message informatif.\n",
             argv[0]);
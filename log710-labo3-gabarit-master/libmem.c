@@ -1,27 +1,207 @@
+#define _GNU_SOURCE
+
 #include "./libmem.h"
 
 #include <assert.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 // IMPORTANT(Alexis Brodeur): Dans ce fichier, et tout code utilisé par ce fichier,
 // vous ne pouvez pas utiliser `malloc`, `free`, etc.
 
 typedef struct block {
-    struct block* previous;
+    // NOTE: Distance en octets jusqu'au bloc précédent, ou 0 pour le premier
+    // bloc. Un décalage relatif garde le tas valide peu importe l'adresse à
+    // laquelle il est projeté.
+    size_t previous;
     size_t size;
     bool free;
     // NOTE(Alexis Brodeur): Vous pouvez ajouter des champs à cette structure de
     // données, mais vous aller perdre des points pour la qualitée.
 } block_t;
 
+#define HEAP_MAGIC 0x4D48303137474F4CULL // "LOG710HM"
+#define HEAP_VERSION 3
+#define HEAP_HEADER_SIZE 512
+#define HEAP_OPEN_RETRIES 1000
+#define SIZE_CLASS_SMALL 128
+#define STRATEGY_LOG_SIZE 16
+#define ADAPTIVE_WINDOW 256
+#define ADAPTIVE_LONG_SCAN 32
+#define ADAPTIVE_HIGH_FRAGMENTATION 0.5
+#define ADAPTIVE_LOW_FRAGMENTATION 0.2
+#define ADAPTIVE_SLIVER_SIZE 16
+#define ASYNC_DEFAULT_CAPACITY 4096
+#define ASYNC_BATCH 64
+#define ASYNC_PERIOD_NS 1000000
+#define PROFILE_DEPTH 32
+#define PROFILE_SKIP 2
+#define PROFILE_STACK_SLOTS 4096
+#define PROFILE_SAMPLE_SLOTS 65536
+
+/**
+ * @brief Superbloc décrivant un tas.
+ *
+ * Pour un tas adossé à un fichier ou partagé, il est stocké au début de la
+ * projection, juste avant le premier bloc. Pour un tas anonyme, il vit dans
+ * `state`. Tout ce qui est partagé entre processus y est exprimé en décalages
+ * par rapport au premier bloc.
+ */
+typedef struct heap {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t block_header_size;
+    size_t len;
+    size_t root;
+    size_t current; // Décalage du bloc courant du *next-fit*, ou de la queue en `MEM_REGION`.
+    size_t region_floor; // Décalage de la dernière marque en `MEM_REGION`.
+    // NOTE: Un retour sous la dernière marque ouvre une génération; une marque
+    // d'une génération passée reste valide si elle est sous le seuil de sa
+    // génération. Les générations plus anciennes que la précédente partagent le
+    // plus bas de leurs seuils, ce qui peut refuser à tort une vieille marque,
+    // jamais en accepter une caduque.
+    size_t region_generation;
+    size_t region_epoch; // Première génération dont les marques peuvent être valides.
+    size_t region_threshold; // Seuil de la génération précédente.
+    size_t region_retained; // Seuil des générations plus anciennes.
+    pthread_mutex_t lock;
+    // NOTE: Statistiques tenues à jour sous le verrou à chaque changement de
+    // bloc, puis publiées dans `published` par un seqlock au déverrouillage.
+    // Les grosses allocations ne sont comptées qu'à la publication.
+    mem_stats_t stats;
+    size_t biggest; // Décalage du plus gros bloc libre, ou SIZE_MAX.
+    size_t others_bound; // Borne sur la taille des autres blocs libres.
+    size_t candidate; // Plus gros bloc libre compté depuis `biggest_stale`.
+    size_t candidate_size;
+    bool biggest_stale;
+    bool stats_changed;
+    // NOTE: Sur sa propre ligne de cache, que les lecteurs peuvent marteler
+    // sans gêner le verrou ni les compteurs de travail.
+    _Alignas(64) size_t sequence;
+    mem_stats_t published;
+} heap_t;
+
+_Static_assert(sizeof(heap_t) <= HEAP_HEADER_SIZE, "heap_t doit tenir dans l'en-tête");
+
+/**
+ * @brief En-tête d'une grosse allocation projetée hors du tas.
+ *
+ * Les grosses allocations forment une liste doublement chaînée, pour que les
+ * statistiques et `mem_is_allocated` les voient.
+ */
+typedef struct large {
+    struct large* previous;
+    struct large* next;
+    size_t size;
+    size_t map_len;
+} large_t;
+
+/**
+ * @brief Pile d'appels distincte vue par le profileur, avec ses totaux.
+ *
+ * Les octets sont pondérés: un échantillon de `size` octets compte pour
+ * `size / (1 - exp(-size / N))` octets, l'inverse de sa probabilité d'être
+ * échantillonné (voir `profile_tick`).
+ */
+typedef struct profile_stack {
+    uint64_t hash;
+    size_t depth; // 0 pour une case vide.
+    void* frames[PROFILE_DEPTH];
+    size_t live_bytes;
+    size_t live_count;
+    size_t total_bytes;
+    size_t total_count;
+} profile_stack_t;
+
+typedef struct profile_sample {
+    void* ptr; // NULL pour une case vide.
+    size_t weight;
+    size_t stack;
+} profile_sample_t;
+
+/**
+ * @brief Case de la file de libérations asynchrones.
+ *
+ * File bornée multi-producteurs de Vyukov: le numéro de séquence de chaque case
+ * indique si elle est prête à être écrite ou lue pour une position donnée.
+ */
+typedef struct async_cell {
+    size_t sequence;
+    void* ptr;
+} async_cell_t;
+
 static struct {
     void* ptr;
     size_t len;
     mem_strategy_t strategy;
-    block_t* current_block;
-    // TODO(Alexis Brodeur): Ajouter au moins 1 champ pour le *next-fit*.
+    // NOTE: La stratégie réellement utilisée; diffère de `strategy` en mode
+    // `MEM_ADAPTIVE`.
+    mem_strategy_t active;
+    struct {
+        size_t allocations;
+        size_t scanned;
+        size_t failures;
+    } window;
+    size_t allocation_count;
+    size_t switch_count;
+    mem_strategy_switch_t switches[STRATEGY_LOG_SIZE];
+    mem_options_t options;
+    heap_t* heap;
+    heap_t anonymous_heap;
+    void* map_ptr;
+    size_t map_len;
+    int fd;
+    struct {
+        large_t* head;
+        size_t count;
+        size_t bytes; // Octets projetés par les grosses allocations.
+    } large;
+    struct {
+        bool enabled;
+        profile_stack_t* stacks;
+        size_t stack_count;
+        profile_sample_t* samples;
+        size_t sample_count;
+        size_t dropped;
+    } profile;
+    struct {
+        bool enabled;
+        uint64_t* fit;
+        size_t* offsets;
+        size_t count;
+        size_t capacity;
+    } index;
+    struct {
+        bool enabled;
+        bool stopping;
+        async_cell_t* cells;
+        size_t mask;
+        size_t enqueue;
+        size_t dequeue;
+        pthread_t reclaimer;
+        pthread_mutex_t lock;
+        pthread_cond_t wake;
+    } async;
 } state;
 
 // IMPORTANT(Alexis Brodeur): Avant de commencer à implémenter le code de ce
@@ -39,6 +219,33 @@ static inline block_t* block_first()
     return state.ptr;
 }
 
+/**
+ * @brief Retourne le bloc précédent dans la liste de blocs.
+ * @note Retourne @e NULL s'il n'y a pas de bloc précédent.
+ *
+ * @param block Un bloc
+ * @return Le bloc précédent
+ */
+static inline block_t* block_previous(block_t* block)
+{
+    if (block->previous == 0) {
+        return NULL;
+    }
+
+    return (block_t*)((char*)block - block->previous);
+}
+
+/**
+ * @brief Change le bloc précédent d'un bloc.
+ *
+ * @param block Un bloc
+ * @param previous Le nouveau bloc précédent, ou @e NULL
+ */
+static inline void block_set_previous(block_t* block, block_t* previous)
+{
+    block->previous = previous == NULL ? 0 : (size_t)((char*)block - (char*)previous);
+}
+
 /**
  * @brief Retourne le prochain bloc dans la liste de blocks.
  * @note Retourne @e NULL s'il n'y a pas de prochain bloc.
@@ -54,113 +261,2133 @@ static block_t* block_next(block_t* block)
     block_t* next_block;
     next_block = ((char*)block) + sizeof(block_t) + block->size;
 
-    if ((char*)next_block < (char*)state.ptr + state.len) {
-        return next_block;
-    } else {
+    if ((char*)next_block < (char*)state.ptr + state.len) {
+        return next_block;
+    } else {
+        return NULL;
+    }
+}
+
+/**
+ * @brief Retourne le bloc courant du *next-fit*.
+ *
+ * @return Le bloc à partir duquel débuter la recherche
+ */
+static inline block_t* block_current(void)
+{
+    return (block_t*)((char*)state.ptr + state.heap->current);
+}
+
+/**
+ * @brief Change le bloc courant du *next-fit*.
+ *
+ * @param block Le nouveau bloc courant
+ */
+static inline void block_set_current(block_t* block)
+{
+    state.heap->current = (size_t)((char*)block - (char*)state.ptr);
+}
+
+// NOTE: L'index de blocs est une structure de tableaux parallèles, en ordre
+// d'adresse: `fit` contient la taille de chaque bloc libre, ou 0 pour un bloc
+// alloué, et `offsets` son décalage. Une recherche parcourt `fit` par vecteurs
+// au lieu de suivre les en-têtes un à un.
+
+/**
+ * @brief Retourne le premier indice dans [begin, end) dont l'entrée vaut au
+ * moins `size`, ou `end`.
+ */
+static size_t index_find_scalar(const uint64_t* fit, size_t begin, size_t end, uint64_t size)
+{
+    for (size_t i = begin; i < end; ++i) {
+        if (fit[i] >= size) {
+            return i;
+        }
+    }
+
+    return end;
+}
+
+/**
+ * @brief Retourne la plus petite entrée d'au moins `size`, ou `UINT64_MAX`.
+ */
+static uint64_t index_min_scalar(const uint64_t* fit, size_t count, uint64_t size)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (fit[i] >= size && fit[i] < best) {
+            best = fit[i];
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Retourne la plus grande entrée.
+ */
+static uint64_t index_max_scalar(const uint64_t* fit, size_t count)
+{
+    uint64_t best = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (fit[i] > best) {
+            best = fit[i];
+        }
+    }
+
+    return best;
+}
+
+#if defined(__x86_64__)
+
+// NOTE: Les tailles sont bornées par la taille du tas, donc les comparaisons
+// signées sur 64 bits sont exactes.
+
+__attribute__((target("sse4.2"))) static size_t index_find_sse(const uint64_t* fit, size_t begin, size_t end, uint64_t size)
+{
+    __m128i threshold = _mm_set1_epi64x((long long)size - 1);
+    size_t i = begin;
+
+    for (; i + 8 <= end; i += 8) {
+        int mask = 0;
+        for (int lane = 0; lane < 4; ++lane) {
+            __m128i entries = _mm_loadu_si128((const __m128i*)(fit + i + 2 * lane));
+            mask |= _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(entries, threshold))) << (2 * lane);
+        }
+
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz((unsigned int)mask);
+        }
+    }
+
+    return index_find_scalar(fit, i, end, size);
+}
+
+__attribute__((target("sse4.2"))) static uint64_t index_min_sse(const uint64_t* fit, size_t count, uint64_t size)
+{
+    __m128i threshold = _mm_set1_epi64x((long long)size - 1);
+    __m128i none = _mm_set1_epi64x(INT64_MAX);
+    __m128i best = none;
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m128i entries = _mm_loadu_si128((const __m128i*)(fit + i));
+        __m128i candidates = _mm_blendv_epi8(none, entries, _mm_cmpgt_epi64(entries, threshold));
+        best = _mm_blendv_epi8(best, candidates, _mm_cmpgt_epi64(best, candidates));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, best);
+    uint64_t result = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+    uint64_t rest = index_min_scalar(fit + i, count - i, size);
+    result = rest < result ? rest : result;
+
+    return result == INT64_MAX ? UINT64_MAX : result;
+}
+
+__attribute__((target("sse4.2"))) static uint64_t index_max_sse(const uint64_t* fit, size_t count)
+{
+    __m128i best = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2) {
+        __m128i entries = _mm_loadu_si128((const __m128i*)(fit + i));
+        best = _mm_blendv_epi8(best, entries, _mm_cmpgt_epi64(entries, best));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, best);
+    uint64_t result = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+    uint64_t rest = index_max_scalar(fit + i, count - i);
+
+    return rest > result ? rest : result;
+}
+
+__attribute__((target("avx2"))) static size_t index_find_avx2(const uint64_t* fit, size_t begin, size_t end, uint64_t size)
+{
+    __m256i threshold = _mm256_set1_epi64x((long long)size - 1);
+    size_t i = begin;
+
+    for (; i + 16 <= end; i += 16) {
+        int mask = 0;
+        for (int lane = 0; lane < 4; ++lane) {
+            __m256i entries = _mm256_loadu_si256((const __m256i*)(fit + i + 4 * lane));
+            mask |= _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(entries, threshold))) << (4 * lane);
+        }
+
+        if (mask != 0) {
+            return i + (size_t)__builtin_ctz((unsigned int)mask);
+        }
+    }
+
+    return index_find_scalar(fit, i, end, size);
+}
+
+__attribute__((target("avx2"))) static uint64_t index_min_avx2(const uint64_t* fit, size_t count, uint64_t size)
+{
+    __m256i threshold = _mm256_set1_epi64x((long long)size - 1);
+    __m256i none = _mm256_set1_epi64x(INT64_MAX);
+    __m256i best = none;
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i entries = _mm256_loadu_si256((const __m256i*)(fit + i));
+        __m256i candidates = _mm256_blendv_epi8(none, entries, _mm256_cmpgt_epi64(entries, threshold));
+        best = _mm256_blendv_epi8(best, candidates, _mm256_cmpgt_epi64(best, candidates));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, best);
+    uint64_t result = index_min_scalar(lanes, 4, 0);
+    uint64_t rest = index_min_scalar(fit + i, count - i, size);
+    result = rest < result ? rest : result;
+
+    return result == INT64_MAX ? UINT64_MAX : result;
+}
+
+__attribute__((target("avx2"))) static uint64_t index_max_avx2(const uint64_t* fit, size_t count)
+{
+    __m256i best = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        __m256i entries = _mm256_loadu_si256((const __m256i*)(fit + i));
+        best = _mm256_blendv_epi8(best, entries, _mm256_cmpgt_epi64(entries, best));
+    }
+
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, best);
+    uint64_t result = index_max_scalar(lanes, 4);
+    uint64_t rest = index_max_scalar(fit + i, count - i);
+
+    return rest > result ? rest : result;
+}
+
+#endif
+
+static struct {
+    size_t (*find)(const uint64_t* fit, size_t begin, size_t end, uint64_t size);
+    uint64_t (*min)(const uint64_t* fit, size_t count, uint64_t size);
+    uint64_t (*max)(const uint64_t* fit, size_t count);
+} index_kernels = { index_find_scalar, index_min_scalar, index_max_scalar };
+
+/**
+ * @brief Choisit les noyaux de recherche selon le processeur.
+ */
+static void index_select_kernels(void)
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        index_kernels.find = index_find_avx2;
+        index_kernels.min = index_min_avx2;
+        index_kernels.max = index_max_avx2;
+    } else if (__builtin_cpu_supports("sse4.2")) {
+        index_kernels.find = index_find_sse;
+        index_kernels.min = index_min_sse;
+        index_kernels.max = index_max_sse;
+    }
+#endif
+}
+
+static inline block_t* index_block(size_t i)
+{
+    return (block_t*)((char*)state.ptr + state.index.offsets[i]);
+}
+
+/**
+ * @brief Retrouve l'indice d'un bloc par recherche dichotomique.
+ */
+static size_t index_lookup(block_t* block)
+{
+    size_t offset = (size_t)((char*)block - (char*)state.ptr);
+    size_t low = 0;
+    size_t high = state.index.count;
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (state.index.offsets[middle] < offset) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    assert(low < state.index.count && state.index.offsets[low] == offset);
+    return low;
+}
+
+static void index_insert(size_t i, block_t* block)
+{
+    size_t moved = state.index.count - i;
+    memmove(state.index.fit + i + 1, state.index.fit + i, moved * sizeof(uint64_t));
+    memmove(state.index.offsets + i + 1, state.index.offsets + i, moved * sizeof(size_t));
+
+    state.index.fit[i] = block->free ? block->size : 0;
+    state.index.offsets[i] = (size_t)((char*)block - (char*)state.ptr);
+    state.index.count++;
+}
+
+static void index_remove(size_t i)
+{
+    size_t moved = state.index.count - i - 1;
+    memmove(state.index.fit + i, state.index.fit + i + 1, moved * sizeof(uint64_t));
+    memmove(state.index.offsets + i, state.index.offsets + i + 1, moved * sizeof(size_t));
+
+    state.index.count--;
+}
+
+/**
+ * @brief Réserve l'index de blocs; la mémoire n'est engagée qu'à l'usage.
+ *
+ * @return @e true si l'index a pu être créé
+ */
+static bool index_start(void)
+{
+    size_t capacity = state.len / (sizeof(block_t) + 1) + 1;
+    void* fit = mmap(NULL, capacity * sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    void* offsets = mmap(NULL, capacity * sizeof(size_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (fit == MAP_FAILED || offsets == MAP_FAILED) {
+        if (fit != MAP_FAILED) {
+            munmap(fit, capacity * sizeof(uint64_t));
+        }
+        if (offsets != MAP_FAILED) {
+            munmap(offsets, capacity * sizeof(size_t));
+        }
+        return false;
+    }
+
+    index_select_kernels();
+
+    state.index.fit = fit;
+    state.index.offsets = offsets;
+    state.index.capacity = capacity;
+    state.index.count = 0;
+    for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
+        index_insert(state.index.count, block);
+    }
+    state.index.enabled = true;
+
+    return true;
+}
+
+static void index_stop(void)
+{
+    if (!state.index.enabled) {
+        return;
+    }
+
+    munmap(state.index.fit, state.index.capacity * sizeof(uint64_t));
+    munmap(state.index.offsets, state.index.capacity * sizeof(size_t));
+    state.index.enabled = false;
+}
+
+/**
+ * @brief Compte un bloc dans les statistiques de travail.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void stats_add(block_t* block)
+{
+    mem_stats_t* stats = &state.heap->stats;
+    state.heap->stats_changed = true;
+
+    if (!block->free) {
+        stats->allocated_block_count++;
+        return;
+    }
+
+    stats->free_block_count++;
+    stats->free_bytes += block->size;
+
+    // NOTE: Tant que le plus gros bloc est inconnu, on suit le plus gros des
+    // blocs comptés depuis; celui qu'un bloc plus gros détrône rejoint la borne.
+    bool stale = state.heap->biggest_stale;
+    size_t* best = stale ? &state.heap->candidate : &state.heap->biggest;
+    size_t* best_size = stale ? &state.heap->candidate_size : &stats->biggest_free_block_size;
+
+    if (*best == SIZE_MAX || block->size > *best_size) {
+        if (*best != SIZE_MAX && *best_size > state.heap->others_bound) {
+            state.heap->others_bound = *best_size;
+        }
+        *best = (size_t)((char*)block - (char*)state.ptr);
+        *best_size = block->size;
+    } else if (block->size > state.heap->others_bound) {
+        state.heap->others_bound = block->size;
+    }
+}
+
+/**
+ * @brief Retire un bloc des statistiques de travail, avant de le modifier.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * Retirer le plus gros bloc libre rend sa taille inconnue jusqu'à la
+ * publication.
+ */
+static void stats_remove(block_t* block)
+{
+    mem_stats_t* stats = &state.heap->stats;
+    state.heap->stats_changed = true;
+
+    if (!block->free) {
+        stats->allocated_block_count--;
+        return;
+    }
+
+    stats->free_block_count--;
+    stats->free_bytes -= block->size;
+
+    size_t offset = (size_t)((char*)block - (char*)state.ptr);
+    if (offset == state.heap->biggest) {
+        state.heap->biggest = SIZE_MAX;
+        state.heap->candidate = SIZE_MAX;
+        state.heap->candidate_size = 0;
+        state.heap->biggest_stale = true;
+    } else if (offset == state.heap->candidate) {
+        state.heap->candidate = SIZE_MAX;
+    }
+}
+
+/**
+ * @brief Recalcule toutes les statistiques de travail en parcourant le tas.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void stats_recount(void)
+{
+    mem_stats_t* stats = &state.heap->stats;
+    stats->free_bytes = 0;
+    stats->free_block_count = 0;
+    stats->allocated_block_count = 0;
+    stats->biggest_free_block_size = 0;
+    state.heap->biggest = SIZE_MAX;
+    state.heap->others_bound = 0;
+    state.heap->candidate = SIZE_MAX;
+    state.heap->biggest_stale = false;
+
+    for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
+        stats_add(block);
+    }
+}
+
+/**
+ * @brief Retrouve le plus gros bloc libre et resserre la borne des autres.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void stats_find_biggest(void)
+{
+    size_t biggest = SIZE_MAX;
+    size_t biggest_size = 0;
+    size_t second_size = 0;
+
+    for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
+        if (!block->free) {
+            continue;
+        }
+
+        if (biggest == SIZE_MAX || block->size > biggest_size) {
+            second_size = biggest == SIZE_MAX ? 0 : biggest_size;
+            biggest = (size_t)((char*)block - (char*)state.ptr);
+            biggest_size = block->size;
+        } else if (block->size > second_size) {
+            second_size = block->size;
+        }
+    }
+
+    state.heap->biggest = biggest;
+    state.heap->stats.biggest_free_block_size = biggest_size;
+    state.heap->others_bound = second_size;
+}
+
+/**
+ * @brief Publie les statistiques de travail si elles ont changé.
+ * @note Le verrou du tas doit être détenu; il n'y a donc qu'un seul écrivain.
+ *
+ * Quand le plus gros bloc a été retiré, le plus gros bloc compté depuis le
+ * remplace s'il dépasse la borne des autres: c'est le cas courant d'un bloc
+ * découpé dont le reste demeure le plus gros. Sinon, on parcourt le tas.
+ */
+static void stats_publish(void)
+{
+    if (!state.heap->stats_changed) {
+        return;
+    }
+
+    mem_stats_t* stats = &state.heap->stats;
+    if (state.heap->biggest_stale) {
+        state.heap->biggest_stale = false;
+        if (stats->free_block_count == 0) {
+            state.heap->biggest = SIZE_MAX;
+            state.heap->others_bound = 0;
+            stats->biggest_free_block_size = 0;
+        } else if (state.heap->candidate != SIZE_MAX && state.heap->candidate_size >= state.heap->others_bound) {
+            state.heap->biggest = state.heap->candidate;
+            stats->biggest_free_block_size = state.heap->candidate_size;
+        } else {
+            stats_find_biggest();
+        }
+    }
+
+    size_t sequence = state.heap->sequence;
+    __atomic_store_n(&state.heap->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&state.heap->published.free_bytes, stats->free_bytes, __ATOMIC_RELAXED);
+    __atomic_store_n(&state.heap->published.free_block_count, stats->free_block_count, __ATOMIC_RELAXED);
+    __atomic_store_n(&state.heap->published.allocated_block_count, stats->allocated_block_count + state.large.count, __ATOMIC_RELAXED);
+    __atomic_store_n(&state.heap->published.biggest_free_block_size, stats->biggest_free_block_size, __ATOMIC_RELAXED);
+    __atomic_store_n(&state.heap->published.large_bytes, state.large.bytes, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&state.heap->sequence, sequence + 2, __ATOMIC_RELEASE);
+    state.heap->stats_changed = false;
+}
+
+/**
+ * @brief Lit un instantané cohérent des statistiques publiées, sans verrou.
+ *
+ * Recommence si une publication était en cours ou a eu lieu pendant la
+ * lecture; un écrivain n'attend jamais un lecteur.
+ */
+static void stats_read(mem_stats_t* stats)
+{
+    for (;;) {
+        size_t before = __atomic_load_n(&state.heap->sequence, __ATOMIC_ACQUIRE);
+        if (before % 2 != 0) {
+            sched_yield();
+            continue;
+        }
+
+        stats->free_bytes = __atomic_load_n(&state.heap->published.free_bytes, __ATOMIC_RELAXED);
+        stats->free_block_count = __atomic_load_n(&state.heap->published.free_block_count, __ATOMIC_RELAXED);
+        stats->allocated_block_count = __atomic_load_n(&state.heap->published.allocated_block_count, __ATOMIC_RELAXED);
+        stats->biggest_free_block_size = __atomic_load_n(&state.heap->published.biggest_free_block_size, __ATOMIC_RELAXED);
+        stats->large_bytes = __atomic_load_n(&state.heap->published.large_bytes, __ATOMIC_RELAXED);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&state.heap->sequence, __ATOMIC_RELAXED) == before) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Acquiert un nombre d'octet du bloc dans le cadre d'une allocation de
+ * mémoire.
+ *
+ * @param block Le noeud libre à utiliser
+ * @param size La taille de l'allocation
+ */
+static void block_acquire(block_t* block, size_t size)
+{
+    assert(block != NULL);
+    assert(block->size >= size);
+    assert(block->free);
+
+    size_t i = state.index.enabled ? index_lookup(block) : 0;
+    stats_remove(block);
+
+    size_t remaining_size = block->size - size;
+    if (remaining_size >= sizeof(block_t) + state.options.min_split) {
+        // NOTE: L'en-tête du reste est écrit avant que le bloc ne rétrécisse:
+        // un processus tué entre les deux laisse une liste encore parcourable,
+        // que `heap_repair` sait remettre en ordre.
+        block_t* split = (block_t*)((char*)(block + 1) + size);
+        block_set_previous(split, block);
+        split->size = remaining_size - sizeof(block_t);
+        split->free = true;
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        block->size = size;
+
+        block_t* next = block_next(split);
+        if (next != NULL) {
+            block_set_previous(next, split);
+        }
+
+        if (state.index.enabled) {
+            index_insert(i + 1, split);
+        }
+        stats_add(split);
+    }
+
+    block->free = false;
+    stats_add(block);
+
+    if (state.index.enabled) {
+        state.index.fit[i] = 0;
+    }
+}
+
+/**
+ * @brief Relâche la mémoire utilisé par une allocation, et fusionne le bloc
+ * avec son précédant et suivant lorsque nécessaire.
+ *
+ * @param block Un bloc à relâcher
+ */
+static void block_release(block_t* block)
+{
+    assert(block != NULL);
+    assert(!block->free);
+
+    block_t* previous = block_previous(block);
+    block_t* next = block_next(block);
+    size_t i = state.index.enabled ? index_lookup(block) : 0;
+    stats_remove(block);
+
+    if (previous != NULL && previous->free) {
+        stats_remove(previous);
+        previous->size += sizeof(block_t) + block->size;
+        if (block_current() == block) {
+            block_set_current(previous);
+        }
+        block = previous;
+
+        if (state.index.enabled) {
+            index_remove(i--);
+        }
+
+        if (next != NULL) {
+            block_set_previous(next, block);
+        }
+    }
+
+    if (next != NULL && next->free) {
+        stats_remove(next);
+        block_t* after_next = block_next(next);
+        if (after_next != NULL) {
+            block_set_previous(after_next, block);
+        }
+
+        block->size += sizeof(block_t) + next->size;
+        if (block_current() == next) {
+            block_set_current(block);
+        }
+
+        if (state.index.enabled) {
+            index_remove(i + 1);
+        }
+    }
+    block->free = true;
+    stats_add(block);
+
+    if (state.index.enabled) {
+        state.index.fit[i] = block->size;
+    }
+
+    // IMPORTANT(Alexis Brodeur):
+    // Que faire si le bloc suivant est libre ?
+    // Que faire si le bloc précédent est libre ?
+}
+
+/**
+ * @brief Applique les options d'un tas, ou les options par défaut.
+ *
+ * @param options Les options, ou @e NULL
+ */
+static void heap_configure(const mem_options_t* options)
+{
+    state.options.min_split = 1;
+    state.options.rounding = MEM_ROUND_NONE;
+    state.options.async_free = false;
+    state.options.async_capacity = 0;
+    state.options.block_index = false;
+    state.options.mmap_threshold = 0;
+    state.options.profile_sample_bytes = 0;
+
+    if (options != NULL) {
+        state.options = *options;
+        if (state.options.min_split == 0) {
+            state.options.min_split = 1;
+        }
+    }
+
+    if (state.options.async_capacity == 0) {
+        state.options.async_capacity = ASYNC_DEFAULT_CAPACITY;
+    }
+}
+
+/**
+ * @brief Change la stratégie active et journalise le changement.
+ * @note Le verrou du tas doit être détenu, sauf à l'initialisation.
+ *
+ * @param strategy La nouvelle stratégie active
+ */
+static void strategy_switch(mem_strategy_t strategy)
+{
+    if (strategy == state.active) {
+        return;
+    }
+
+    mem_strategy_switch_t* entry = &state.switches[state.switch_count % STRATEGY_LOG_SIZE];
+    entry->allocation = state.allocation_count;
+    entry->from = state.active;
+    entry->to = strategy;
+
+    state.switch_count++;
+    state.active = strategy;
+}
+
+/**
+ * @brief Réinitialise la stratégie d'un tas fraîchement projeté.
+ *
+ * @param strategy La stratégie demandée, possiblement `MEM_ADAPTIVE`
+ */
+static void strategy_reset(mem_strategy_t strategy)
+{
+    state.strategy = strategy;
+    state.active = strategy == MEM_ADAPTIVE ? MEM_FIRST_FIT : strategy;
+    state.window.allocations = 0;
+    state.window.scanned = 0;
+    state.window.failures = 0;
+    state.allocation_count = 0;
+    state.switch_count = 0;
+}
+
+/**
+ * @brief Choisit une stratégie à la fin d'une fenêtre en mode `MEM_ADAPTIVE`.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * Les échecs ou une fragmentation élevée mènent au *best-fit*, une majorité de
+ * petits fragments au *worst-fit*, qui garde de gros restes. Une fois le tas
+ * sain, de longues recherches mènent au *next-fit*, et le *first-fit* reprend
+ * après le *best-fit* ou le *worst-fit* quand la fragmentation redescend.
+ */
+static void strategy_adapt(void)
+{
+    size_t free_blocks = 0;
+    size_t free_bytes = 0;
+    size_t biggest = 0;
+    size_t slivers = 0;
+
+    for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
+        if (block->free) {
+            free_blocks++;
+            free_bytes += block->size;
+            biggest = block->size > biggest ? block->size : biggest;
+            slivers += block->size < ADAPTIVE_SLIVER_SIZE;
+        }
+    }
+
+    double fragmentation = free_bytes == 0 ? 0.0 : 1.0 - (double)biggest / (double)free_bytes;
+    size_t average_scan = state.window.scanned / state.window.allocations;
+    bool searching = state.active != MEM_NEXT_FIT;
+
+    if (state.window.failures > 0 || fragmentation > ADAPTIVE_HIGH_FRAGMENTATION) {
+        strategy_switch(MEM_BEST_FIT);
+    } else if (slivers * 2 > free_blocks && free_blocks > ADAPTIVE_SLIVER_SIZE) {
+        strategy_switch(MEM_WORST_FIT);
+    } else if (searching && average_scan > ADAPTIVE_LONG_SCAN) {
+        strategy_switch(MEM_NEXT_FIT);
+    } else if (searching && fragmentation < ADAPTIVE_LOW_FRAGMENTATION) {
+        strategy_switch(MEM_FIRST_FIT);
+    }
+
+    state.window.allocations = 0;
+    state.window.scanned = 0;
+    state.window.failures = 0;
+}
+
+/**
+ * @brief Arrondit la taille d'une allocation selon l'option `rounding`.
+ *
+ * Avec les classes de taille, les petites tailles sont arrondies au multiple de
+ * 16 et les plus grandes au quart de leur puissance de deux, ce qui borne la
+ * perte interne à 25%.
+ *
+ * @param size La taille demandée
+ * @return La taille arrondie, ou 0 si elle déborde
+ */
+static size_t size_round(size_t size)
+{
+    size_t step = 1;
+
+    switch (state.options.rounding) {
+    case MEM_ROUND_16:
+        step = 16;
+        break;
+    case MEM_ROUND_SIZE_CLASS:
+        if (size <= SIZE_CLASS_SMALL) {
+            step = 16;
+        } else {
+            size_t log2 = sizeof(size_t) * 8 - 1 - (size_t)__builtin_clzl(size - 1);
+            step = (size_t)1 << (log2 - 2);
+        }
+        break;
+    default:
+        break;
+    }
+
+    size_t rounded = (size + step - 1) & ~(step - 1);
+    return rounded < size ? 0 : rounded;
+}
+
+/**
+ * @brief Initialise le verrou du tas.
+ *
+ * Le verrou d'un tas projeté est partagé entre processus et robuste: si un
+ * processus meurt en le détenant, le prochain à le prendre valide le tas avant
+ * de continuer.
+ *
+ * @param shared Si le verrou doit être partagé entre processus
+ */
+static void heap_lock_init(bool shared)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    if (shared) {
+        pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    }
+    pthread_mutex_init(&state.heap->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static bool heap_repair(void);
+
+static void heap_lock(void)
+{
+    int err = pthread_mutex_lock(&state.heap->lock);
+    if (err == EOWNERDEAD) {
+        if (!heap_repair()) {
+            (void)fprintf(stderr, "libmem: heap corrupted by a dead process\n");
+            abort();
+        }
+        pthread_mutex_consistent(&state.heap->lock);
+    } else if (err != 0) {
+        (void)fprintf(stderr, "libmem: failed to lock heap (%d)\n", err);
+        abort();
+    }
+}
+
+static void heap_unlock(void)
+{
+    stats_publish();
+    pthread_mutex_unlock(&state.heap->lock);
+}
+
+// NOTE: Le profileur échantillonne en moyenne une allocation tous les
+// `profile_sample_bytes` octets alloués par un fil. Le compte à rebours est
+// local au fil; seules les allocations échantillonnées paient `backtrace` et
+// une insertion dans les tables, sous le verrou du tas.
+
+static __thread size_t profile_countdown;
+static __thread uint64_t profile_seed;
+
+/**
+ * @brief Tire le nombre d'octets avant le prochain échantillon, selon une loi
+ * exponentielle de moyenne `profile_sample_bytes`.
+ */
+static size_t profile_interval(void)
+{
+    if (profile_seed == 0) {
+        profile_seed = (uint64_t)(uintptr_t)&profile_seed | 1;
+    }
+    profile_seed ^= profile_seed << 13;
+    profile_seed ^= profile_seed >> 7;
+    profile_seed ^= profile_seed << 17;
+
+    double uniform = ((double)(profile_seed >> 11) + 1.0) / 9007199254740993.0;
+    return (size_t)(-log(uniform) * (double)state.options.profile_sample_bytes) + 1;
+}
+
+/**
+ * @brief Compte une allocation et indique si elle doit être échantillonnée.
+ *
+ * Avec des intervalles exponentiels, une allocation de `size` octets est
+ * échantillonnée avec une probabilité de 1 - exp(-size / N); son poids est
+ * l'inverse de cette probabilité, ce qui rend l'estimation sans biais pour
+ * chaque pile d'appels.
+ *
+ * @param size La taille de l'allocation
+ * @param weight Reçoit les octets représentés par l'échantillon
+ * @return @e true si l'allocation doit être échantillonnée
+ */
+static bool profile_tick(size_t size, size_t* weight)
+{
+    if (profile_seed == 0) {
+        profile_countdown = profile_interval();
+    }
+
+    if (size < profile_countdown) {
+        profile_countdown -= size;
+        return false;
+    }
+
+    double probability = -expm1(-(double)size / (double)state.options.profile_sample_bytes);
+    *weight = (size_t)((double)size / probability);
+    profile_countdown = profile_interval();
+
+    return true;
+}
+
+static inline size_t profile_slot(void* ptr)
+{
+    return (size_t)(((uint64_t)(uintptr_t)ptr * 0x9E3779B97F4A7C15ULL) >> 32) & (PROFILE_SAMPLE_SLOTS - 1);
+}
+
+/**
+ * @brief Retrouve ou ajoute une pile d'appels.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * @return L'indice de la pile, ou `PROFILE_STACK_SLOTS` si la table est pleine
+ */
+static size_t profile_intern(void* const* frames, size_t depth)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < depth; ++i) {
+        hash = (hash ^ (uint64_t)(uintptr_t)frames[i]) * 0x100000001B3ULL;
+    }
+
+    for (size_t i = hash & (PROFILE_STACK_SLOTS - 1);; i = (i + 1) & (PROFILE_STACK_SLOTS - 1)) {
+        profile_stack_t* stack = &state.profile.stacks[i];
+
+        if (stack->depth == 0) {
+            if (state.profile.stack_count >= PROFILE_STACK_SLOTS / 4 * 3) {
+                return PROFILE_STACK_SLOTS;
+            }
+
+            stack->hash = hash;
+            stack->depth = depth;
+            memcpy(stack->frames, frames, depth * sizeof(void*));
+            state.profile.stack_count++;
+            return i;
+        }
+
+        if (stack->hash == hash && stack->depth == depth && memcmp(stack->frames, frames, depth * sizeof(void*)) == 0) {
+            return i;
+        }
+    }
+}
+
+/**
+ * @brief Enregistre une allocation échantillonnée avec la pile de l'appelant
+ * de `mem_alloc`.
+ */
+__attribute__((noinline)) static void profile_record(void* ptr, size_t weight)
+{
+    void* frames[PROFILE_DEPTH + PROFILE_SKIP];
+    int depth = backtrace(frames, PROFILE_DEPTH + PROFILE_SKIP);
+    if (depth <= PROFILE_SKIP) {
+        return;
+    }
+
+    heap_lock();
+    size_t stack = profile_intern(frames + PROFILE_SKIP, (size_t)depth - PROFILE_SKIP);
+
+    if (stack == PROFILE_STACK_SLOTS || state.profile.sample_count >= PROFILE_SAMPLE_SLOTS / 4 * 3) {
+        state.profile.dropped++;
+    } else {
+        size_t i = profile_slot(ptr);
+        while (state.profile.samples[i].ptr != NULL) {
+            i = (i + 1) & (PROFILE_SAMPLE_SLOTS - 1);
+        }
+
+        state.profile.samples[i].ptr = ptr;
+        state.profile.samples[i].weight = weight;
+        state.profile.samples[i].stack = stack;
+        state.profile.sample_count++;
+
+        profile_stack_t* entry = &state.profile.stacks[stack];
+        entry->live_bytes += weight;
+        entry->live_count++;
+        entry->total_bytes += weight;
+        entry->total_count++;
+    }
+    heap_unlock();
+}
+
+/**
+ * @brief Retrouve l'échantillon d'une allocation.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * @return L'indice de l'échantillon, ou `PROFILE_SAMPLE_SLOTS`
+ */
+static size_t profile_lookup(void* ptr)
+{
+    if (state.profile.sample_count == 0) {
+        return PROFILE_SAMPLE_SLOTS;
+    }
+
+    for (size_t i = profile_slot(ptr); state.profile.samples[i].ptr != NULL; i = (i + 1) & (PROFILE_SAMPLE_SLOTS - 1)) {
+        if (state.profile.samples[i].ptr == ptr) {
+            return i;
+        }
+    }
+
+    return PROFILE_SAMPLE_SLOTS;
+}
+
+/**
+ * @brief Oublie l'échantillon d'une allocation libérée, s'il existe.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * Retire la case par décalage arrière pour garder le sondage linéaire valide
+ * sans pierres tombales.
+ */
+static void profile_forget(void* ptr)
+{
+    if (!state.profile.enabled) {
+        return;
+    }
+
+    size_t i = profile_lookup(ptr);
+    if (i == PROFILE_SAMPLE_SLOTS) {
+        return;
+    }
+
+    profile_stack_t* stack = &state.profile.stacks[state.profile.samples[i].stack];
+    stack->live_bytes -= state.profile.samples[i].weight;
+    stack->live_count--;
+    state.profile.sample_count--;
+
+    for (size_t j = (i + 1) & (PROFILE_SAMPLE_SLOTS - 1); state.profile.samples[j].ptr != NULL; j = (j + 1) & (PROFILE_SAMPLE_SLOTS - 1)) {
+        size_t home = profile_slot(state.profile.samples[j].ptr);
+        bool movable = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+
+        if (movable) {
+            state.profile.samples[i] = state.profile.samples[j];
+            i = j;
+        }
+    }
+
+    state.profile.samples[i].ptr = NULL;
+}
+
+/**
+ * @brief Oublie tous les échantillons dans [begin, end).
+ * @note Le verrou du tas doit être détenu.
+ *
+ * Parcourt toute la table: à n'utiliser que pour abandonner des blocs en bloc.
+ */
+static void profile_forget_range(void* begin, void* end)
+{
+    if (!state.profile.enabled || state.profile.sample_count == 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < PROFILE_SAMPLE_SLOTS;) {
+        void* ptr = state.profile.samples[i].ptr;
+
+        // NOTE: Le décalage arrière peut ramener une autre entrée dans la case
+        // `i`; on la réexamine avant d'avancer.
+        if (ptr != NULL && ptr >= begin && ptr < end) {
+            profile_forget(ptr);
+        } else {
+            ++i;
+        }
+    }
+}
+
+/**
+ * @brief Reporte l'échantillon d'une allocation déplacée.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void profile_move(void* from, void* to)
+{
+    if (!state.profile.enabled || from == to) {
+        return;
+    }
+
+    size_t i = profile_lookup(from);
+    if (i == PROFILE_SAMPLE_SLOTS) {
+        return;
+    }
+
+    profile_sample_t sample = state.profile.samples[i];
+    profile_forget(from);
+
+    size_t j = profile_slot(to);
+    while (state.profile.samples[j].ptr != NULL) {
+        j = (j + 1) & (PROFILE_SAMPLE_SLOTS - 1);
+    }
+
+    sample.ptr = to;
+    state.profile.samples[j] = sample;
+    state.profile.sample_count++;
+
+    profile_stack_t* stack = &state.profile.stacks[sample.stack];
+    stack->live_bytes += sample.weight;
+    stack->live_count++;
+}
+
+/**
+ * @brief Réserve les tables du profileur; la mémoire n'est engagée qu'à
+ * l'usage.
+ *
+ * @return @e true si le profileur a pu être démarré
+ */
+static bool profile_start(void)
+{
+    void* stacks = mmap(NULL, PROFILE_STACK_SLOTS * sizeof(profile_stack_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    void* samples = mmap(NULL, PROFILE_SAMPLE_SLOTS * sizeof(profile_sample_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    if (stacks == MAP_FAILED || samples == MAP_FAILED) {
+        if (stacks != MAP_FAILED) {
+            munmap(stacks, PROFILE_STACK_SLOTS * sizeof(profile_stack_t));
+        }
+        if (samples != MAP_FAILED) {
+            munmap(samples, PROFILE_SAMPLE_SLOTS * sizeof(profile_sample_t));
+        }
+        return false;
+    }
+
+    // NOTE: Le premier appel à `backtrace` charge libgcc, qui alloue avec
+    // `malloc`; on le fait ici plutôt qu'au milieu d'une allocation.
+    void* frame;
+    backtrace(&frame, 1);
+
+    state.profile.stacks = stacks;
+    state.profile.stack_count = 0;
+    state.profile.samples = samples;
+    state.profile.sample_count = 0;
+    state.profile.dropped = 0;
+    state.profile.enabled = true;
+
+    return true;
+}
+
+static void profile_stop(void)
+{
+    if (!state.profile.enabled) {
+        return;
+    }
+
+    munmap(state.profile.stacks, PROFILE_STACK_SLOTS * sizeof(profile_stack_t));
+    munmap(state.profile.samples, PROFILE_SAMPLE_SLOTS * sizeof(profile_sample_t));
+    state.profile.enabled = false;
+}
+
+// NOTE: En `MEM_REGION`, le curseur pointe sur la queue: le dernier bloc, libre
+// tant qu'il reste de la place. Les blocs qui la précèdent sont alloués, sauf
+// les blocs libres laissés par une autre stratégie avant le passage en région.
+// La queue ne redescend jamais sous la dernière marque, ni par une libération
+// ni par une fusion avec un de ces blocs libres, sinon un bloc alloué ensuite
+// pourrait chevaucher l'en-tête qu'elle désigne.
+
+/**
+ * @brief Libère un bloc en `MEM_REGION`.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * Seul le dernier bloc alloué depuis la dernière marque est rendu à la queue;
+ * les autres restent alloués jusqu'à `mem_reset` ou `mem_reset_to`.
+ */
+static void region_release(block_t* block)
+{
+    block_t* tail = block_current();
+
+    if ((size_t)((char*)block - (char*)state.ptr) < state.heap->region_floor) {
+        return;
+    }
+
+    block_t* previous = block_previous(block);
+    if (previous != NULL && previous->free && (size_t)((char*)previous - (char*)state.ptr) < state.heap->region_floor) {
+        return;
+    }
+
+    if ((block == tail && !block->free) || (block_next(block) == tail && tail->free)) {
+        block_release(block);
+    }
+}
+
+/**
+ * @brief Fait du bloc donné la queue libre du tas, abandonnant tous les blocs
+ * qui le suivent.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * @param block Le bloc qui devient la queue
+ * @param mark La marque du bloc, qui porte les statistiques des blocs qui le
+ * précèdent
+ */
+static void region_truncate(block_t* block, const mem_mark_t* mark)
+{
+    size_t offset = (size_t)((char*)block - (char*)state.ptr);
+
+    block->size = state.len - offset - sizeof(block_t);
+    block->free = true;
+    block_set_current(block);
+    state.heap->region_floor = offset;
+
+    // NOTE: Les blocs abandonnés ne sont pas retirés un à un; seuls les blocs
+    // libres sous la marque restent comptés, et la borne reste valide pour eux.
+    mem_stats_t* stats = &state.heap->stats;
+    stats->allocated_block_count = mark->allocated_blocks;
+    stats->free_block_count = mark->free_blocks;
+    stats->free_bytes = mark->free_bytes;
+    if (mark->free_blocks == 0) {
+        state.heap->biggest = SIZE_MAX;
+        state.heap->others_bound = 0;
+        state.heap->biggest_stale = false;
+    } else if (state.heap->biggest_stale || state.heap->biggest >= offset) {
+        state.heap->biggest = SIZE_MAX;
+        state.heap->candidate = SIZE_MAX;
+        state.heap->biggest_stale = true;
+    }
+    stats_add(block);
+
+    if (state.index.enabled) {
+        size_t i = index_lookup(block);
+        state.index.fit[i] = block->size;
+        state.index.count = i + 1;
+    }
+
+    profile_forget_range(block + 1, (char*)state.ptr + state.len);
+}
+
+/**
+ * @brief Place le curseur sur le dernier bloc pour commencer une région.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void region_seek_tail(void)
+{
+    block_t* tail = block_first();
+
+    for (block_t* block = tail; block != NULL; block = block_next(block)) {
+        tail = block;
+    }
+
+    block_set_current(tail);
+}
+
+/**
+ * @brief Ouvre une génération de marques après un retour au décalage donné.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * @param offset Le décalage du retour; les marques au-delà deviennent caduques
+ */
+static void region_invalidate(size_t offset)
+{
+    size_t generation = state.heap->region_generation;
+    size_t retained = offset;
+
+    if (generation >= state.heap->region_epoch + 1 && state.heap->region_threshold < retained) {
+        retained = state.heap->region_threshold;
+    }
+    if (generation >= state.heap->region_epoch + 2 && state.heap->region_retained < retained) {
+        retained = state.heap->region_retained;
+    }
+
+    state.heap->region_retained = retained;
+    state.heap->region_threshold = offset;
+    state.heap->region_generation = generation + 1;
+}
+
+/**
+ * @brief Rend caduques toutes les marques prises jusqu'ici.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void region_forget_marks(void)
+{
+    state.heap->region_generation++;
+    state.heap->region_epoch = state.heap->region_generation;
+}
+
+/**
+ * @brief Commence une région à la queue du tas, sans marque valide.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * Le curseur persisté peut venir d'une autre stratégie, et les marques d'une
+ * région précédente ne désignent plus rien.
+ */
+static void region_start(void)
+{
+    region_seek_tail();
+    state.heap->region_floor = 0;
+    region_forget_marks();
+}
+
+/**
+ * @brief Indique si une marque désigne encore une frontière de bloc.
+ * @note Le verrou du tas doit être détenu.
+ */
+static bool region_mark_valid(const mem_mark_t* mark)
+{
+    size_t generation = state.heap->region_generation;
+
+    if (mark->generation < state.heap->region_epoch || mark->generation > generation) {
+        return false;
+    }
+
+    if (mark->generation == generation) {
+        return mark->offset <= state.heap->region_floor;
+    }
+
+    if (mark->generation + 1 == generation) {
+        return mark->offset <= state.heap->region_threshold;
+    }
+
+    return mark->offset <= state.heap->region_retained;
+}
+
+/**
+ * @brief Libère un bloc selon la stratégie active.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void heap_release(void* ptr)
+{
+    profile_forget(ptr);
+
+    if (state.active == MEM_REGION) {
+        region_release((block_t*)ptr - 1);
+    } else {
+        block_release((block_t*)ptr - 1);
+    }
+}
+
+/**
+ * @brief Ajoute un pointeur à la file de libérations, sans verrou.
+ *
+ * @return @e false si la file est pleine
+ */
+static bool async_push(void* ptr)
+{
+    size_t position = __atomic_load_n(&state.async.enqueue, __ATOMIC_RELAXED);
+
+    while (true) {
+        async_cell_t* cell = &state.async.cells[position & state.async.mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        if (difference == 0) {
+            if (__atomic_compare_exchange_n(&state.async.enqueue, &position, position + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->ptr = ptr;
+                __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (difference < 0) {
+            return false;
+        } else {
+            position = __atomic_load_n(&state.async.enqueue, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Retire un pointeur de la file de libérations.
+ * @note Le verrou du tas doit être détenu: il sérialise les consommateurs.
+ *
+ * @return Le pointeur, ou @e NULL si la file est vide
+ */
+static void* async_pop(void)
+{
+    size_t position = state.async.dequeue;
+    async_cell_t* cell = &state.async.cells[position & state.async.mask];
+
+    if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != position + 1) {
+        return NULL;
+    }
+
+    void* ptr = cell->ptr;
+    __atomic_store_n(&cell->sequence, position + state.async.mask + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&state.async.dequeue, position + 1, __ATOMIC_RELEASE);
+
+    return ptr;
+}
+
+/**
+ * @brief Retourne le nombre approximatif de pointeurs en attente.
+ */
+static size_t async_size(void)
+{
+    size_t enqueue = __atomic_load_n(&state.async.enqueue, __ATOMIC_RELAXED);
+    size_t dequeue = __atomic_load_n(&state.async.dequeue, __ATOMIC_RELAXED);
+    return enqueue - dequeue;
+}
+
+/**
+ * @brief Libère jusqu'à `max` pointeurs en attente.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * @return Le nombre de pointeurs libérés
+ */
+static size_t async_drain(size_t max)
+{
+    size_t count = 0;
+
+    for (void* ptr; count < max && (ptr = async_pop()) != NULL; ++count) {
+        heap_release(ptr);
+    }
+
+    return count;
+}
+
+static void* async_reclaimer(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&state.async.lock);
+    while (!state.async.stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += ASYNC_PERIOD_NS;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&state.async.wake, &state.async.lock, &deadline);
+        pthread_mutex_unlock(&state.async.lock);
+
+        // NOTE: Le verrou du tas est relâché entre les lots pour ne pas
+        // bloquer les allocations pendant une longue vidange.
+        size_t count;
+        do {
+            heap_lock();
+            count = async_drain(ASYNC_BATCH);
+            heap_unlock();
+        } while (count == ASYNC_BATCH);
+
+        pthread_mutex_lock(&state.async.lock);
+    }
+    pthread_mutex_unlock(&state.async.lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Crée la file de libérations et démarre le fil de récupération.
+ *
+ * @return @e true si le mode asynchrone a pu être activé
+ */
+static bool async_start(void)
+{
+    size_t capacity = 1;
+    while (capacity < state.options.async_capacity) {
+        capacity <<= 1;
+    }
+
+    async_cell_t* cells = mmap(NULL, capacity * sizeof(async_cell_t), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (cells == MAP_FAILED) {
+        return false;
+    }
+
+    for (size_t i = 0; i < capacity; ++i) {
+        cells[i].sequence = i;
+    }
+
+    state.async.cells = cells;
+    state.async.mask = capacity - 1;
+    state.async.enqueue = 0;
+    state.async.dequeue = 0;
+    state.async.stopping = false;
+    pthread_mutex_init(&state.async.lock, NULL);
+    pthread_cond_init(&state.async.wake, NULL);
+
+    if (pthread_create(&state.async.reclaimer, NULL, async_reclaimer, NULL) != 0) {
+        pthread_cond_destroy(&state.async.wake);
+        pthread_mutex_destroy(&state.async.lock);
+        munmap(cells, capacity * sizeof(async_cell_t));
+        return false;
+    }
+
+    state.async.enabled = true;
+    return true;
+}
+
+/**
+ * @brief Arrête le fil de récupération et libère ce qui reste en attente.
+ */
+static void async_stop(void)
+{
+    if (!state.async.enabled) {
+        return;
+    }
+
+    pthread_mutex_lock(&state.async.lock);
+    state.async.stopping = true;
+    pthread_cond_signal(&state.async.wake);
+    pthread_mutex_unlock(&state.async.lock);
+    pthread_join(state.async.reclaimer, NULL);
+
+    heap_lock();
+    async_drain(SIZE_MAX);
+    heap_unlock();
+
+    pthread_cond_destroy(&state.async.wake);
+    pthread_mutex_destroy(&state.async.lock);
+    munmap(state.async.cells, (state.async.mask + 1) * sizeof(async_cell_t));
+    state.async.enabled = false;
+}
+
+/**
+ * @brief Initialise le superbloc et un unique bloc libre couvrant tout le tas.
+ *
+ * @param shared Si le tas peut être partagé entre processus
+ */
+static void heap_format(bool shared)
+{
+    state.heap->version = HEAP_VERSION;
+    state.heap->block_header_size = sizeof(block_t);
+    state.heap->len = state.len;
+    state.heap->root = 0;
+    state.heap->current = 0;
+    state.heap->region_floor = 0;
+    state.heap->region_generation = 0;
+    state.heap->region_epoch = 0;
+    state.heap->region_threshold = 0;
+    state.heap->region_retained = 0;
+    heap_lock_init(shared);
+
+    block_t* a_block = block_first();
+    a_block->previous = 0;
+    a_block->free = true;
+    a_block->size = state.len - sizeof(block_t);
+
+    state.heap->sequence = 0;
+    stats_recount();
+    stats_publish();
+
+    // NOTE: Le nombre magique est écrit en dernier, un autre processus qui
+    // ouvre le tas attend de le voir avant d'y toucher.
+    __atomic_store_n(&state.heap->magic, HEAP_MAGIC, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Vérifie la cohérence d'un tas existant.
+ *
+ * Le superbloc doit correspondre à cette version de la librairie, et la liste
+ * de blocs doit couvrir exactement le tas: chaque taille reste dans les bornes,
+ * chaque lien vers le bloc précédent est exact et deux blocs libres ne se
+ * suivent jamais.
+ *
+ * @return @e true si le tas est cohérent
+ */
+static bool heap_check(void)
+{
+    if (state.heap->magic != HEAP_MAGIC
+        || state.heap->version != HEAP_VERSION
+        || state.heap->block_header_size != sizeof(block_t)
+        || state.heap->len != state.len) {
+        return false;
+    }
+
+    if (state.heap->root >= state.len) {
+        return false;
+    }
+
+    size_t offset = 0;
+    size_t previous = 0;
+    bool previous_free = false;
+    bool current_found = false;
+
+    while (offset < state.len) {
+        if (state.len - offset < sizeof(block_t)) {
+            return false;
+        }
+
+        block_t* block = (block_t*)((char*)state.ptr + offset);
+        if (block->size > state.len - offset - sizeof(block_t)) {
+            return false;
+        }
+
+        if (block->previous != offset - previous) {
+            return false;
+        }
+
+        if (block->free && previous_free) {
+            return false;
+        }
+
+        if (offset == state.heap->current) {
+            current_found = true;
+        }
+
+        previous = offset;
+        previous_free = block->free;
+        offset += sizeof(block_t) + block->size;
+    }
+
+    return current_found;
+}
+
+/**
+ * @brief Répare un tas laissé en plein milieu d'une opération par un processus
+ * mort.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * Les en-têtes sont écrits dans un ordre qui garde la liste parcourable par
+ * les tailles. Il ne reste qu'à refaire les liens vers les blocs précédents,
+ * fusionner les blocs libres voisins, replacer le curseur s'il ne désigne plus
+ * un bloc et recompter les statistiques. Un bloc dont l'allocation ou la
+ * libération a été interrompue reste dans son état d'avant.
+ *
+ * @return @e false si le tas ne peut pas être parcouru
+ */
+static bool heap_repair(void)
+{
+    if (state.heap->magic != HEAP_MAGIC
+        || state.heap->version != HEAP_VERSION
+        || state.heap->block_header_size != sizeof(block_t)
+        || state.heap->len != state.len) {
+        return false;
+    }
+
+    for (size_t offset = 0; offset < state.len;) {
+        if (state.len - offset < sizeof(block_t)) {
+            return false;
+        }
+
+        block_t* block = (block_t*)((char*)state.ptr + offset);
+        if (block->size > state.len - offset - sizeof(block_t)) {
+            return false;
+        }
+
+        offset += sizeof(block_t) + block->size;
+    }
+
+    block_t* previous = NULL;
+    bool current_found = false;
+
+    for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
+        if (previous != NULL && previous->free && block->free) {
+            previous->size += sizeof(block_t) + block->size;
+            block = previous;
+            continue;
+        }
+
+        block_set_previous(block, previous);
+        if ((size_t)((char*)block - (char*)state.ptr) == state.heap->current) {
+            current_found = true;
+        }
+        previous = block;
+    }
+
+    if (state.active == MEM_REGION) {
+        region_seek_tail();
+    } else if (!current_found) {
+        state.heap->current = 0;
+    }
+
+    if (state.heap->root >= state.len) {
+        state.heap->root = 0;
+    }
+
+    // NOTE: Le processus mort a pu laisser les compteurs à moitié à jour, et la
+    // séquence impaire s'il est mort en pleine publication.
+    state.heap->sequence &= ~(size_t)1;
+    stats_recount();
+
+    return true;
+}
+
+/**
+ * @brief Projette un tas adossé à un descripteur de fichier.
+ *
+ * @param fd Le descripteur, dont `state` devient propriétaire
+ * @param size La taille de la zone de blocs
+ * @param strategy La stratégie d'allocation
+ * @return @e true si la projection a réussi
+ */
+static bool heap_map(int fd, size_t size, mem_strategy_t strategy)
+{
+    size_t map_len = HEAP_HEADER_SIZE + size;
+    void* map_ptr = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map_ptr == MAP_FAILED) {
+        return false;
+    }
+
+    state.ptr = (char*)map_ptr + HEAP_HEADER_SIZE;
+    state.len = size;
+    strategy_reset(strategy);
+    heap_configure(NULL);
+    state.heap = map_ptr;
+    state.map_ptr = map_ptr;
+    state.map_len = map_len;
+    state.fd = fd;
+
+    return true;
+}
+
+/**
+ * @brief Défait la projection d'un tas et ferme son descripteur.
+ */
+static void heap_unmap(void)
+{
+    munmap(state.map_ptr, state.map_len);
+    if (state.fd >= 0) {
+        close(state.fd);
+    }
+
+    state.ptr = NULL;
+    state.heap = NULL;
+    state.map_ptr = NULL;
+    state.fd = -1;
+}
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+void mem_init(size_t size, mem_strategy_t strategy)
+{
+    // NOTE: L'interface du laboratoire ne permet pas de signaler l'échec.
+    if (!mem_init_ex(size, strategy, NULL)) {
+        (void)fprintf(stderr, "libmem: failed to map heap\n");
+        abort();
+    }
+}
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+bool mem_init_ex(size_t size, mem_strategy_t strategy, const mem_options_t* options)
+{
+    assert(size > 0);
+    assert(strategy >= 0);
+    assert(strategy < NUM_MEM_STRATEGIES);
+
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    state.ptr = ptr;
+    state.len = size;
+    strategy_reset(strategy);
+    heap_configure(options);
+    state.heap = &state.anonymous_heap;
+    state.map_ptr = state.ptr;
+    state.map_len = size;
+    state.fd = -1;
+    heap_format(false);
+
+    // NOTE: `mem_deinit` défait ce qui a déjà été mis en place.
+    if (state.options.block_index && !index_start()) {
+        mem_deinit();
+        return false;
+    }
+
+    if (state.options.profile_sample_bytes != 0 && !profile_start()) {
+        mem_deinit();
+        return false;
+    }
+
+    if (state.options.async_free && !async_start()) {
+        mem_deinit();
+        return false;
+    }
+    return true;
+}
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+bool mem_init_file(const char* path, size_t size, mem_strategy_t strategy)
+{
+    assert(path != NULL);
+    assert(size > sizeof(block_t));
+    assert(strategy >= 0);
+    assert(strategy < NUM_MEM_STRATEGIES);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    // NOTE: Un seul processus à la fois ouvre le fichier: le verrou est tenu
+    // jusqu'à la fermeture du descripteur dans `mem_deinit`. Cela ferme la
+    // course entre deux créateurs et permet de réinitialiser le verrou du tas
+    // sans qu'un autre processus ne le détienne.
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return false;
+    }
+
+    size_t map_len = HEAP_HEADER_SIZE + size;
+    bool created = file_stat.st_size == 0;
+    if (created && ftruncate(fd, (off_t)map_len) != 0) {
+        close(fd);
+        return false;
+    }
+
+    if (!created && (size_t)file_stat.st_size != map_len) {
+        close(fd);
+        return false;
+    }
+
+    if (!heap_map(fd, size, strategy)) {
+        close(fd);
+        return false;
+    }
+
+    // NOTE: Le nombre magique est écrit en dernier; sans lui, la création du
+    // tas a été interrompue et il n'y a rien à préserver.
+    if (created || state.heap->magic == 0) {
+        heap_format(true);
+        return true;
+    }
+
+    // NOTE: Le verrou persisté date du processus précédent, qui ne peut plus le
+    // détenir puisque le fichier nous appartient. Ce processus a pu être tué en
+    // pleine opération; le tas est réparé comme après la mort du détenteur du
+    // verrou.
+    heap_lock_init(true);
+    if (!heap_repair()) {
+        heap_unmap();
+        return false;
+    }
+    if (state.active == MEM_REGION) {
+        region_start();
+    }
+    stats_publish();
+
+    return true;
+}
+
+// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+bool mem_init_shared(const char* name, size_t size, mem_strategy_t strategy)
+{
+    assert(size > sizeof(block_t));
+    assert(strategy >= 0);
+    assert(strategy < NUM_MEM_STRATEGIES);
+
+    size_t map_len = HEAP_HEADER_SIZE + size;
+    bool created = true;
+    int fd;
+
+    // NOTE: Un objet nommé survit au dernier processus qui l'utilise, jusqu'à
+    // `mem_unlink_shared`. Sans nom, il disparaît avec sa dernière projection.
+    if (name == NULL) {
+        fd = memfd_create("libmem", MFD_CLOEXEC);
+    } else {
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0 && errno == EEXIST) {
+            created = false;
+            fd = shm_open(name, O_RDWR, 0600);
+        }
+    }
+
+    if (fd < 0) {
+        return false;
+    }
+
+    if (created && ftruncate(fd, (off_t)map_len) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // NOTE: Le créateur peut ne pas encore avoir dimensionné l'objet.
+    for (int retry = 0; !created; ++retry) {
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) != 0 || retry == HEAP_OPEN_RETRIES) {
+            close(fd);
+            return false;
+        }
+
+        if ((size_t)file_stat.st_size == map_len) {
+            break;
+        }
+
+        if (file_stat.st_size != 0) {
+            close(fd);
+            return false;
+        }
+
+        sched_yield();
+    }
+
+    if (!heap_map(fd, size, strategy)) {
+        close(fd);
+        return false;
+    }
+
+    if (created) {
+        heap_format(true);
+        return true;
+    }
+
+    for (int retry = 0; __atomic_load_n(&state.heap->magic, __ATOMIC_ACQUIRE) != HEAP_MAGIC; ++retry) {
+        if (retry == HEAP_OPEN_RETRIES) {
+            heap_unmap();
+            return false;
+        }
+
+        sched_yield();
+    }
+
+    heap_lock();
+    bool valid = heap_check();
+    if (valid && state.active == MEM_REGION) {
+        region_start();
+    }
+    heap_unlock();
+
+    if (!valid) {
+        heap_unmap();
+        return false;
+    }
+
+    return true;
+}
+
+bool mem_unlink_shared(const char* name)
+{
+    assert(name != NULL);
+
+    return shm_unlink(name) == 0;
+}
+
+void mem_deinit(void)
+{
+    // TODO(Alexis Brodeur): Libérez la mémoire utilisée par votre gestionnaire.
+    async_stop();
+    index_stop();
+    profile_stop();
+
+    while (state.large.head != NULL) {
+        large_t* large = state.large.head;
+        state.large.head = large->next;
+        munmap(large, large->map_len);
+    }
+    state.large.count = 0;
+    state.large.bytes = 0;
+
+    if (state.fd >= 0) {
+        msync(state.map_ptr, state.map_len, MS_SYNC);
+    } else {
+        pthread_mutex_destroy(&state.heap->lock);
+    }
+
+    heap_unmap();
+}
+
+size_t mem_to_offset(void* ptr)
+{
+    if (ptr == NULL) {
+        return 0;
+    }
+
+    assert((char*)ptr > (char*)state.ptr);
+    assert((char*)ptr < (char*)state.ptr + state.len);
+
+    return (size_t)((char*)ptr - (char*)state.ptr);
+}
+
+void* mem_from_offset(size_t offset)
+{
+    if (offset == 0) {
+        return NULL;
+    }
+
+    assert(offset < state.len);
+
+    return (char*)state.ptr + offset;
+}
+
+void mem_set_root(void* ptr)
+{
+    heap_lock();
+    state.heap->root = mem_to_offset(ptr);
+    heap_unlock();
+}
+
+void* mem_get_root(void)
+{
+    heap_lock();
+    void* root = mem_from_offset(state.heap->root);
+    heap_unlock();
+
+    return root;
+}
+
+/**
+ * @brief Indique si une allocation valide a été projetée hors du tas.
+ *
+ * @param ptr Un pointeur retourné par `mem_alloc`
+ * @return @e true s'il s'agit d'une grosse allocation
+ */
+static inline bool large_owns(void* ptr)
+{
+    return (char*)ptr < (char*)state.ptr || (char*)ptr >= (char*)state.ptr + state.len;
+}
+
+/**
+ * @brief Retourne la taille de la projection d'une grosse allocation, ou 0 en
+ * cas de débordement.
+ */
+static size_t large_length(size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (size > SIZE_MAX - sizeof(large_t) - page) {
+        return 0;
+    }
+
+    return (sizeof(large_t) + size + page - 1) / page * page;
+}
+
+/**
+ * @brief Ajoute une grosse allocation à la liste.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void large_link(large_t* large)
+{
+    large->previous = NULL;
+    large->next = state.large.head;
+    if (state.large.head != NULL) {
+        state.large.head->previous = large;
+    }
+    state.large.head = large;
+    state.large.count++;
+    state.large.bytes += large->map_len;
+    state.heap->stats_changed = true;
+}
+
+/**
+ * @brief Retire une grosse allocation de la liste.
+ * @note Le verrou du tas doit être détenu.
+ */
+static void large_unlink(large_t* large)
+{
+    if (large->previous != NULL) {
+        large->previous->next = large->next;
+    } else {
+        state.large.head = large->next;
+    }
+    if (large->next != NULL) {
+        large->next->previous = large->previous;
+    }
+    state.large.count--;
+    state.large.bytes -= large->map_len;
+    state.heap->stats_changed = true;
+}
+
+/**
+ * @brief Projette une région dédiée pour une grosse allocation.
+ *
+ * @param size La taille de l'allocation
+ * @return La mémoire allouée, ou @e NULL
+ */
+static void* large_alloc(size_t size)
+{
+    size_t length = large_length(size);
+    if (length == 0) {
+        return NULL;
+    }
+
+    large_t* large = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (large == MAP_FAILED) {
         return NULL;
     }
+    large->size = size;
+    large->map_len = length;
+
+    heap_lock();
+    large_link(large);
+    heap_unlock();
+
+    return large + 1;
+}
+
+static void large_free(large_t* large)
+{
+    heap_lock();
+    profile_forget(large + 1);
+    large_unlink(large);
+    heap_unlock();
+
+    munmap(large, large->map_len);
 }
 
 /**
- * @brief Acquiert un nombre d'octet du bloc dans le cadre d'une allocation de
- * mémoire.
+ * @brief Redimensionne une grosse allocation avec `mremap`, sans copie.
  *
- * @param block Le noeud libre à utiliser
- * @param size La taille de l'allocation
+ * @return La mémoire redimensionnée, ou @e NULL si l'allocation est inchangée
  */
-static void block_acquire(block_t* block, size_t size)
+static void* large_resize(large_t* large, size_t size)
 {
-    assert(block != NULL);
-    assert(block->size >= size);
-    assert(block->free);
+    size_t length = large_length(size);
+    if (length == 0) {
+        return NULL;
+    }
 
-    size_t remaining_size = block->size - size;
-    if (remaining_size > sizeof(block_t)) {
-        block->size = size;
-        block_t* split = block_next(block);
-        split->previous = block;
-        split->size = remaining_size - sizeof(block_t);
-        split->free = true;
+    // NOTE: La projection peut être déplacée; on la retire de la liste le temps
+    // du `mremap`.
+    heap_lock();
+    large_unlink(large);
+    heap_unlock();
 
-        block_t* next = block_next(split);
-        if (next != NULL) {
-            next->previous = split;
-        }
+    large_t* resized = mremap(large, large->map_len, length, MREMAP_MAYMOVE);
+    if (resized != MAP_FAILED) {
+        resized->size = size;
+        resized->map_len = length;
     }
 
-    block->free = false;
+    heap_lock();
+    large_link(resized != MAP_FAILED ? resized : large);
+    if (resized != MAP_FAILED) {
+        profile_move(large + 1, resized + 1);
+    }
+    heap_unlock();
+
+    return resized != MAP_FAILED ? resized + 1 : NULL;
 }
 
 /**
- * @brief Relâche la mémoire utilisé par une allocation, et fusionne le bloc
- * avec son précédant et suivant lorsque nécessaire.
+ * @brief Cherche un bloc libre dans l'index de blocs et l'acquiert.
+ * @note Le verrou du tas doit être détenu.
  *
- * @param block Un bloc à relâcher
+ * Le *best-fit* et le *worst-fit* trouvent d'abord la taille visée, puis le
+ * premier bloc de cette taille, comme les boucles sur les en-têtes.
+ *
+ * @param size La taille de l'allocation
+ * @return La mémoire allouée, ou @e NULL si aucun bloc ne convient
  */
-static void block_release(block_t* block)
+static void* index_alloc(size_t size)
 {
-    assert(block != NULL);
-    assert(!block->free);
-
-    block_t* previous = block->previous;
-    block_t* next = block_next(block);
-
-    if (previous != NULL && previous->free) {
-        previous->size += sizeof(block_t) + block->size;
-        block = previous;
-
-        if (next != NULL) {
-            next->previous = block;
+    const uint64_t* fit = state.index.fit;
+    size_t count = state.index.count;
+    size_t i = count;
+
+    switch (state.active) {
+    case MEM_FIRST_FIT:
+        i = index_kernels.find(fit, 0, count, size);
+        break;
+    case MEM_BEST_FIT: {
+        uint64_t best = index_kernels.min(fit, count, size);
+        if (best != UINT64_MAX) {
+            i = index_kernels.find(fit, 0, count, best);
+            while (fit[i] != best) {
+                i = index_kernels.find(fit, i + 1, count, best);
+            }
         }
-    }
-
-    if (next != NULL && next->free) {
-        block_t* after_next = block_next(next);
-        if (after_next != NULL) {
-            after_next->previous = block;
+    } break;
+    case MEM_WORST_FIT: {
+        uint64_t worst = index_kernels.max(fit, count);
+        if (worst >= size) {
+            i = index_kernels.find(fit, 0, count, worst);
         }
-
-        block->size += sizeof(block_t) + next->size;
+    } break;
+    case MEM_NEXT_FIT:
+        i = index_kernels.find(fit, index_lookup(block_current()), count, size);
+        if (i == count) {
+            i = index_kernels.find(fit, 0, count, size);
+        }
+        break;
+    default:
+        break;
     }
-    block->free = true;
 
-    // IMPORTANT(Alexis Brodeur):
-    // Que faire si le bloc suivant est libre ?
-    // Que faire si le bloc précédent est libre ?
-}
+    state.window.scanned += i < count ? i + 1 : count;
 
-// NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-void mem_init(size_t size, mem_strategy_t strategy)
-{
-    assert(size > 0);
-    assert(strategy >= 0);
-    assert(strategy < NUM_MEM_STRATEGIES);
+    if (i == count) {
+        return NULL;
+    }
 
-    printf("before\n");
-    state.ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, 0, 0);
-    printf("after mmap\n");
-    if (state.ptr == MAP_FAILED) {
-        printf("Mapping Failed\n");
+    block_t* block = index_block(i);
+    block_acquire(block, size);
+    if (state.active == MEM_NEXT_FIT) {
+        block_set_current(block);
     }
-    state.len = size;
-    state.strategy = strategy;
-    block_t* a_block = block_first();
-    a_block->previous = NULL;
-    a_block->free = true;
-    a_block->size = state.len - sizeof(block_t);
-}
 
-void mem_deinit(void)
-{
-    // TODO(Alexis Brodeur): Libérez la mémoire utilisée par votre gestionnaire.
-    int err;
-    err = munmap(state.ptr, state.len);
+    return block + 1;
 }
 
-void* mem_alloc(size_t size)
+/**
+ * @brief Cherche un bloc libre selon la stratégie et l'acquiert.
+ * @note Le verrou du tas doit être détenu.
+ *
+ * @param size La taille de l'allocation
+ * @return La mémoire allouée, ou @e NULL si aucun bloc ne convient
+ */
+static void* heap_alloc(size_t size)
 {
-    assert(size > 0);
-
     // TODO(Alexis Brodeur): Alloue un bloc de `size` octets.
     //
     // Ce bloc et ses métadonnées doivent être réservées dans la mémoire pointée
@@ -174,11 +2401,15 @@ void* mem_alloc(size_t size)
 
     // boucle for pour trouver le bon espace libre
 
-    switch (state.strategy) {
+    if (state.index.enabled && state.active != MEM_REGION) {
+        return index_alloc(size);
+    }
+
+    switch (state.active) {
     case MEM_FIRST_FIT: {
         for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
-            if (block->free && block->size + sizeof(block_t) >= size) {
-                printf("rentrer dans condition. /n");
+            state.window.scanned++;
+            if (block->free && block->size >= size) {
                 block_acquire(block, size);
                 return block + 1;
             }
@@ -191,12 +2422,17 @@ void* mem_alloc(size_t size)
         block_t* temp = NULL;
 
         for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
-            if (block->free && block->size + sizeof(block_t) >= size && block->size < min_size) {
+            state.window.scanned++;
+            if (block->free && block->size >= size && block->size < min_size) {
                 temp = block;
                 min_size = block->size;
             }
         }
 
+        if (temp == NULL) {
+            return NULL;
+        }
+
         block_acquire(temp, size);
         return temp + 1;
     } break;
@@ -206,31 +2442,32 @@ void* mem_alloc(size_t size)
         block_t* temp_worst = NULL;
 
         for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
-            if (block->free && block->size + sizeof(block_t) >= size && block->size > max_size) {
+            state.window.scanned++;
+            if (block->free && block->size >= size && block->size > max_size) {
                 temp_worst = block;
                 max_size = block->size;
             }
         }
 
+        if (temp_worst == NULL) {
+            return NULL;
+        }
+
         block_acquire(temp_worst, size);
         return temp_worst + 1;
     } break;
 
     case MEM_NEXT_FIT: {
 
-        // initialize the current block and block size variables if this is the first allocation request
-        if (state.current_block == NULL) {
-            state.current_block = block_first();
-        }
-
         // 1. loop
         // je pars de current block et je m arrete a la fin de la liste
 
-        for (block_t* block = state.current_block; block != NULL; block = block_next(block)) {
+        for (block_t* block = block_current(); block != NULL; block = block_next(block)) {
+            state.window.scanned++;
             if (block->free && block->size >= size) {
                 // acquire the block and update the current block
                 block_acquire(block, size);
-                state.current_block = block;
+                block_set_current(block);
                 // return a pointer to the allocated memory
                 return (char*)block + sizeof(block_t);
             }
@@ -240,10 +2477,11 @@ void* mem_alloc(size_t size)
         // je commence du debut et je m'arrete a current block
 
         for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
+            state.window.scanned++;
             if (block->free && block->size >= size) {
                 // acquire the block and update the current block
                 block_acquire(block, size);
-                state.current_block = block;
+                block_set_current(block);
                 // return a pointer to the allocated memory
                 return (char*)block + sizeof(block_t);
             }
@@ -253,73 +2491,323 @@ void* mem_alloc(size_t size)
         return NULL;
 
     } break;
+    case MEM_REGION: {
+        block_t* tail = block_current();
+        state.window.scanned++;
+        if (!tail->free || tail->size < size) {
+            return NULL;
+        }
+
+        block_acquire(tail, size);
+        block_t* next = block_next(tail);
+        if (next != NULL) {
+            block_set_current(next);
+        }
+
+        return tail + 1;
+    } break;
+    default:
+        break;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Arrondit la taille, puis alloue dans le tas sous son verrou.
+ *
+ * @param size La taille demandée
+ * @return La mémoire allouée, ou @e NULL
+ */
+static void* heap_allocate(size_t size)
+{
+    size = size_round(size);
+    if (size == 0) {
+        return NULL;
+    }
+
+    heap_lock();
+    void* ptr = heap_alloc(size);
+
+    // NOTE: Des blocs en attente de libération peuvent suffire.
+    if (ptr == NULL && state.async.enabled && async_drain(SIZE_MAX) > 0) {
+        ptr = heap_alloc(size);
+    }
+
+    state.allocation_count++;
+    state.window.allocations++;
+    state.window.failures += ptr == NULL;
+    if (state.strategy == MEM_ADAPTIVE && state.window.allocations == ADAPTIVE_WINDOW) {
+        strategy_adapt();
+    }
+    heap_unlock();
+
+    return ptr;
+}
+
+void* mem_alloc(size_t size)
+{
+    assert(size > 0);
+
+    void* ptr;
+    if (state.options.mmap_threshold != 0 && size >= state.options.mmap_threshold) {
+        ptr = large_alloc(size);
+    } else {
+        ptr = heap_allocate(size);
+    }
+
+    size_t weight;
+    if (ptr != NULL && state.profile.enabled && profile_tick(size, &weight)) {
+        profile_record(ptr, weight);
     }
+
+    return ptr;
 }
 
 void mem_free(void* ptr)
 {
     assert(ptr != NULL);
-    block_t* block = (block_t*)ptr - 1;
-    block_release(block);
+
+    if (large_owns(ptr)) {
+        large_free((large_t*)ptr - 1);
+        return;
+    }
+
+    if (state.async.enabled && async_push(ptr)) {
+        size_t pending = async_size();
+
+        if (pending % ASYNC_BATCH == 0) {
+            pthread_cond_signal(&state.async.wake);
+        }
+
+        // NOTE: Contre-pression: passé les trois quarts de la file, celui qui
+        // libère aide le fil de récupération.
+        if (pending > state.async.mask / 4 * 3) {
+            heap_lock();
+            async_drain(ASYNC_BATCH);
+            heap_unlock();
+        }
+
+        return;
+    }
+
+    heap_lock();
+    if (state.async.enabled) {
+        async_drain(ASYNC_BATCH);
+    }
+    heap_release(ptr);
+    heap_unlock();
 }
 
-size_t mem_get_free_block_count()
+void* mem_realloc(void* ptr, size_t size)
 {
-    size_t compteur = 0;
-    for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
-        if (block->free) {
-            compteur++;
+    assert(size > 0);
+
+    if (ptr == NULL) {
+        return mem_alloc(size);
+    }
+
+    bool large = state.options.mmap_threshold != 0 && size >= state.options.mmap_threshold;
+    size_t old_size;
+
+    if (large_owns(ptr)) {
+        if (large) {
+            return large_resize((large_t*)ptr - 1, size);
         }
+        old_size = ((large_t*)ptr - 1)->size;
+    } else {
+        old_size = ((block_t*)ptr - 1)->size;
+        if (!large && size <= old_size) {
+            return ptr;
+        }
+    }
+
+    void* moved = mem_alloc(size);
+    if (moved == NULL) {
+        return NULL;
     }
-    return compteur;
+
+    memcpy(moved, ptr, old_size < size ? old_size : size);
+    mem_free(ptr);
+
+    return moved;
 }
 
-size_t mem_get_allocated_block_count()
+mem_mark_t mem_mark(void)
 {
-    size_t compteur = 0;
-    for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
-        if (block->free == false) {
-            compteur++;
-        }
+    heap_lock();
+    assert(state.active == MEM_REGION);
+    // NOTE: Une libération en attente appliquée après la marque pourrait viser
+    // un bloc sous le nouveau plancher.
+    if (state.async.enabled) {
+        async_drain(SIZE_MAX);
     }
-    return compteur;
-    return 0;
+    block_t* tail = block_current();
+    mem_stats_t* stats = &state.heap->stats;
+    state.heap->region_floor = (size_t)((char*)tail - (char*)state.ptr);
+    mem_mark_t mark = {
+        .offset = state.heap->region_floor,
+        .generation = state.heap->region_generation,
+        .allocated_blocks = stats->allocated_block_count - !tail->free,
+        .free_blocks = stats->free_block_count - tail->free,
+        .free_bytes = stats->free_bytes - (tail->free ? tail->size : 0),
+    };
+    heap_unlock();
+
+    return mark;
 }
 
-size_t mem_get_free_bytes()
+bool mem_reset_to(mem_mark_t mark)
 {
-    // TODO(Alexis Brodeur): Indiquez combien d'octets sont disponibles pour
-    // des allocations de mémoire.
-    size_t free_bytes = 0;
+    assert(mark.offset < state.len);
+
+    heap_lock();
+    assert(state.active == MEM_REGION);
+
+    // NOTE: Un retour à une marque plus ancienne que la dernière rend les
+    // marques suivantes caduques; leur en-tête a pu être recouvert depuis.
+    bool valid = region_mark_valid(&mark);
+    if (valid) {
+        if (state.async.enabled) {
+            async_drain(SIZE_MAX);
+        }
+
+        if (mark.offset < state.heap->region_floor) {
+            region_invalidate(mark.offset);
+        }
 
-    // Traverse the list of blocks and add the size of free blocks to the total
-    block_t* current_block = block_first();
-    while (current_block != NULL) {
-        if (current_block->free) {
-            free_bytes += current_block->size;
+        block_t* block = (block_t*)((char*)state.ptr + mark.offset);
+        if (block < block_current()) {
+            region_truncate(block, &mark);
         }
-        current_block = block_next(current_block);
     }
+    heap_unlock();
 
-    return free_bytes;
+    return valid;
 }
 
-size_t mem_get_biggest_free_block_size()
+void mem_reset(void)
 {
-    // TODO(Alexis Brodeur): Indiquez la taille en octets du plus gros plus de
-    // mémoire libre.
+    heap_lock();
+    if (state.async.enabled) {
+        async_drain(SIZE_MAX);
+    }
+    region_forget_marks();
+    mem_mark_t start = { 0 };
+    region_truncate(block_first(), &start);
+    heap_unlock();
+}
 
-    size_t biggest_free_block_size = 0;
-    block_t* current_block = block_first();
+void mem_flush(void)
+{
+    if (!state.async.enabled) {
+        return;
+    }
 
-    while (current_block != NULL) {
-        if (current_block->free && current_block->size > biggest_free_block_size) {
-            biggest_free_block_size = current_block->size;
-        }
-        current_block = block_next(current_block);
+    heap_lock();
+    async_drain(SIZE_MAX);
+    heap_unlock();
+}
+
+void mem_set_strategy(mem_strategy_t strategy)
+{
+    assert(strategy >= 0);
+    assert(strategy < NUM_MEM_STRATEGIES);
+
+    heap_lock();
+    // NOTE: Les libérations en attente s'appliquent selon l'ancienne stratégie;
+    // en région, elles seraient différées jusqu'à `mem_reset`.
+    if (state.async.enabled) {
+        async_drain(SIZE_MAX);
+    }
+    state.strategy = strategy;
+    if (strategy != MEM_ADAPTIVE) {
+        strategy_switch(strategy);
+    } else if (state.active == MEM_REGION) {
+        // NOTE: Le mode adaptatif ne choisit que parmi les stratégies de
+        // recherche; il ne doit pas rester sur une région.
+        strategy_switch(MEM_FIRST_FIT);
+    }
+    if (strategy == MEM_REGION) {
+        region_start();
+    }
+    state.window.allocations = 0;
+    state.window.scanned = 0;
+    state.window.failures = 0;
+    heap_unlock();
+}
+
+mem_strategy_t mem_get_strategy(void)
+{
+    heap_lock();
+    mem_strategy_t strategy = state.active;
+    heap_unlock();
+
+    return strategy;
+}
+
+size_t mem_get_strategy_switch_count()
+{
+    heap_lock();
+    size_t count = state.switch_count;
+    heap_unlock();
+
+    return count;
+}
+
+size_t mem_get_strategy_switches(mem_strategy_switch_t* switches, size_t max)
+{
+    assert(switches != NULL || max == 0);
+
+    heap_lock();
+    size_t count = state.switch_count < STRATEGY_LOG_SIZE ? state.switch_count : STRATEGY_LOG_SIZE;
+    count = count < max ? count : max;
+
+    for (size_t i = 0; i < count; ++i) {
+        switches[i] = state.switches[(state.switch_count - count + i) % STRATEGY_LOG_SIZE];
     }
+    heap_unlock();
+
+    return count;
+}
+
+void mem_get_stats(mem_stats_t* stats)
+{
+    assert(stats != NULL);
+
+    stats_read(stats);
+}
+
+size_t mem_get_free_block_count()
+{
+    mem_stats_t stats;
+    stats_read(&stats);
+    return stats.free_block_count;
+}
+
+size_t mem_get_allocated_block_count()
+{
+    mem_stats_t stats;
+    stats_read(&stats);
+    return stats.allocated_block_count;
+}
+
+size_t mem_get_free_bytes()
+{
+    // TODO(Alexis Brodeur): Indiquez combien d'octets sont disponibles pour
+    // des allocations de mémoire.
+    mem_stats_t stats;
+    stats_read(&stats);
+    return stats.free_bytes;
+}
 
-    return biggest_free_block_size;
+size_t mem_get_biggest_free_block_size()
+{
+    // TODO(Alexis Brodeur): Indiquez la taille en octets du plus gros plus de
+    // mémoire libre.
+    mem_stats_t stats;
+    stats_read(&stats);
+    return stats.biggest_free_block_size;
 }
 
 size_t mem_count_small_free_blocks(size_t max_bytes)
@@ -331,6 +2819,7 @@ size_t mem_count_small_free_blocks(size_t max_bytes)
 
     size_t count = 0;
 
+    heap_lock();
     block_t* block = block_first();
 
     while (block != NULL) {
@@ -340,6 +2829,7 @@ size_t mem_count_small_free_blocks(size_t max_bytes)
 
         block = block_next(block);
     }
+    heap_unlock();
 
     return count;
 }
@@ -353,7 +2843,10 @@ bool mem_is_allocated(void* ptr)
     // NOTE(Alexis Brodeur): Ce pointeur peut pointer vers n'importe quelle
     // adresse mémoire.
 
+    bool allocated = false;
+
     // Get the first block in the linked list.
+    heap_lock();
     block_t* block = block_first();
 
     // Iterate through the blocks in the linked list.
@@ -363,19 +2856,24 @@ bool mem_is_allocated(void* ptr)
         if (ptr >= (void*)((char*)block + sizeof(block_t)) && ptr < (void*)((char*)block + sizeof(block_t) + block->size)) {
             // If the block is marked as not free, then the memory pointed to
             // by ptr is allocated, so we return true.
-            if (!block->free) {
-                return true;
-            }
+            allocated = !block->free;
+            break;
         }
 
         // Move on to the next block in the linked list.
         block = block_next(block);
     }
 
+    for (large_t* large = state.large.head; large != NULL && !allocated; large = large->next) {
+        allocated = ptr >= (void*)(large + 1) && ptr < (void*)((char*)(large + 1) + large->size);
+    }
+
+    heap_unlock();
+
     // If we reach the end of the linked list without finding a block that
     // contains ptr, then the memory pointed to by ptr is not allocated,
     // so we return false.
-    return false;
+    return allocated;
 }
 
 void mem_print_state(void)
@@ -395,6 +2893,7 @@ void mem_print_state(void)
     // ```
     // A100 F24 A20 A58 F20 A27 F600
     // ```
+    heap_lock();
     for (block_t* block = block_first(); block != NULL; block = block_next(block)) {
         if (block->free) {
             printf("F%zu ", block->size);
@@ -402,25 +2901,95 @@ void mem_print_state(void)
             printf("A%zu ", block->size);
         }
     }
+    heap_unlock();
+}
+
+/**
+ * @brief Écrit une adresse de retour sous forme symbolique, si possible.
+ */
+static void profile_write_frame(int fd, void* frame)
+{
+    Dl_info info;
+
+    if (dladdr(frame, &info) == 0 || info.dli_fname == NULL) {
+        dprintf(fd, "%p", frame);
+    } else if (info.dli_sname != NULL) {
+        dprintf(fd, "%s+0x%zx", info.dli_sname, (size_t)((char*)frame - (char*)info.dli_saddr));
+    } else {
+        const char* name = strrchr(info.dli_fname, '/');
+        dprintf(fd, "%s+0x%zx", name != NULL ? name + 1 : info.dli_fname, (size_t)((char*)frame - (char*)info.dli_fbase));
+    }
+}
+
+bool mem_profile_dump(const char* path, mem_profile_t profile)
+{
+    assert(path != NULL);
+
+    if (!state.profile.enabled) {
+        return false;
+    }
+
+    size_t length = PROFILE_STACK_SLOTS * sizeof(profile_stack_t);
+    profile_stack_t* stacks = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stacks == MAP_FAILED) {
+        return false;
+    }
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        munmap(stacks, length);
+        return false;
+    }
+
+    // NOTE: On copie les piles pour ne pas bloquer les allocations pendant la
+    // symbolisation et l'écriture.
+    heap_lock();
+    memcpy(stacks, state.profile.stacks, length);
+    heap_unlock();
+
+    // NOTE: Format « folded » de flamegraph.pl: les appelants d'abord, séparés
+    // par des points-virgules, puis le nombre d'octets estimé.
+    for (size_t i = 0; i < PROFILE_STACK_SLOTS; ++i) {
+        profile_stack_t* stack = &stacks[i];
+        size_t bytes = profile == MEM_PROFILE_LIVE ? stack->live_bytes : stack->total_bytes;
+
+        if (stack->depth == 0 || bytes == 0) {
+            continue;
+        }
+
+        for (size_t frame = stack->depth; frame > 0; --frame) {
+            profile_write_frame(fd, stack->frames[frame - 1]);
+            dprintf(fd, frame > 1 ? ";" : " ");
+        }
+        dprintf(fd, "%zu\n", bytes);
+    }
+
+    close(fd);
+    munmap(stacks, length);
+
+    return true;
 }
 
 void test1()
 {
     printf("1");
+    heap_lock();
     block_acquire(block_first(), 100);
     block_t* nouveau_block = ((char*)state.ptr) + sizeof(block_t) + 100;
     assert(nouveau_block != NULL);
     assert(nouveau_block->free);
-    assert(nouveau_block->previous == state.ptr);
+    assert(block_previous(nouveau_block) == state.ptr);
     assert(nouveau_block->size == 876);
     assert(block_next(state.ptr) == nouveau_block);
     assert(block_next(block_next(state.ptr)) == NULL);
     assert(block_first()->free == false);
+    heap_unlock();
 }
 
 void test2()
 {
     printf("2");
+    heap_lock();
     block_acquire(state.ptr, 100);
     block_t* nouveau_block = ((char*)state.ptr) + sizeof(block_t) + 100;
     block_release(state.ptr);
@@ -429,4 +2998,5 @@ void test2()
     assert(block_first()->free);
     assert(block_first()->size == 1000);
     assert(block_next(block_first()) == NULL);
+    heap_unlock();
 }
@@ -11,17 +11,93 @@ typedef enum {
     MEM_BEST_FIT,
     MEM_WORST_FIT,
     MEM_NEXT_FIT,
+    MEM_ADAPTIVE,
+    MEM_REGION,
     NUM_MEM_STRATEGIES,
 } mem_strategy_t;
 
+typedef struct {
+    size_t allocation;
+    mem_strategy_t from;
+    mem_strategy_t to;
+} mem_strategy_switch_t;
+
+typedef struct {
+    size_t offset;
+    size_t generation;
+    size_t allocated_blocks;
+    size_t free_blocks;
+    size_t free_bytes;
+} mem_mark_t;
+
+typedef struct {
+    size_t free_bytes;
+    size_t free_block_count;
+    size_t allocated_block_count;
+    size_t biggest_free_block_size;
+    size_t large_bytes;
+} mem_stats_t;
+
+typedef enum {
+    MEM_ROUND_NONE,
+    MEM_ROUND_16,
+    MEM_ROUND_SIZE_CLASS,
+} mem_rounding_t;
+
+typedef struct {
+    size_t min_split;
+    mem_rounding_t rounding;
+    bool async_free;
+    size_t async_capacity;
+    bool block_index;
+    size_t mmap_threshold;
+    size_t profile_sample_bytes;
+} mem_options_t;
+
+typedef enum {
+    MEM_PROFILE_LIVE,
+    MEM_PROFILE_CUMULATIVE,
+} mem_profile_t;
+
 void mem_init(size_t size, mem_strategy_t strategy);
 
+bool mem_init_ex(size_t size, mem_strategy_t strategy, const mem_options_t* options);
+
+bool mem_init_file(const char* path, size_t size, mem_strategy_t strategy);
+
+bool mem_init_shared(const char* name, size_t size, mem_strategy_t strategy);
+
+bool mem_unlink_shared(const char* name);
+
 void mem_deinit(void);
 
 void* mem_alloc(size_t size);
 
 void mem_free(void* ptr);
 
+void* mem_realloc(void* ptr, size_t size);
+
+void mem_flush(void);
+
+mem_mark_t mem_mark(void);
+
+bool mem_reset_to(mem_mark_t mark);
+
+void mem_reset(void);
+
+// NOTE: En quittant `MEM_REGION`, les blocs dont la libération a été différée
+// restent alloués: rien ne les distingue des blocs vivants. Seul `mem_reset`
+// les récupère; dans un tas adossé à un fichier, ils y restent persistés.
+void mem_set_strategy(mem_strategy_t strategy);
+
+mem_strategy_t mem_get_strategy(void);
+
+size_t mem_get_strategy_switch_count();
+
+size_t mem_get_strategy_switches(mem_strategy_switch_t* switches, size_t max);
+
+void mem_get_stats(mem_stats_t* stats);
+
 size_t mem_get_free_block_count();
 
 size_t mem_get_allocated_block_count();
@@ -36,6 +112,16 @@ bool mem_is_allocated(void* ptr);
 
 void mem_print_state(void);
 
+bool mem_profile_dump(const char* path, mem_profile_t profile);
+
+size_t mem_to_offset(void* ptr);
+
+void* mem_from_offset(size_t offset);
+
+void mem_set_root(void* ptr);
+
+void* mem_get_root(void);
+
 void test1();
 void test2();
 